@@ -0,0 +1,34 @@
+#pragma once
+// Generated by tools/pack_atlas.py from img/*.png; do not edit.
+
+/// the sprites packed into img/atlas.png
+namespace Atlas {
+	struct Sprite {
+		char const* name;
+		int x, y, width, height;
+	};
+
+	static const int width = 2048, height = 1024;
+
+	enum SpriteId {
+		closedCell, digTarget, freeCell, minedCell, numCell1, numCell2, numCell3, numCell4, numCell5, numCell6, numCell7, numCell8, obstacleCell, player,
+		spriteNum
+	};
+
+	static const Sprite sprites[spriteNum] = {
+		{"closedCell", 518, 2, 256, 256},
+		{"digTarget", 778, 2, 256, 256},
+		{"freeCell", 1038, 2, 256, 256},
+		{"minedCell", 1298, 2, 256, 256},
+		{"numCell1", 1558, 2, 256, 256},
+		{"numCell2", 518, 262, 256, 256},
+		{"numCell3", 778, 262, 256, 256},
+		{"numCell4", 1038, 262, 256, 256},
+		{"numCell5", 1298, 262, 256, 256},
+		{"numCell6", 1558, 262, 256, 256},
+		{"numCell7", 2, 518, 256, 256},
+		{"numCell8", 262, 522, 256, 256},
+		{"obstacleCell", 522, 522, 256, 256},
+		{"player", 2, 2, 512, 512},
+	};
+}
@@ -0,0 +1,59 @@
+#include "AtlasRects.h"
+#include "core/AssetLoader.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// Loads the sprites the way the game starts up, once on one thread and once on
+// several, then from img/textures.cache if it is there (tools/cook_textures.py),
+// and prints the startup report of each. The upload is a copy of the pixels into
+// a buffer the size of the texture, standing in for the texture lock.
+// usage: minepanzer_bench_asset_load [threads] [files...]
+//   (by default img/atlas.png and every sprite's own file)
+namespace {
+	void loadAll(std::vector<std::string> const& paths, int const threadNum, TextureCache const* cache) {
+		AssetLoader loader(paths, threadNum, cache);
+		std::vector<uint8_t> texture;
+		while(!loader.isDone()) {
+			auto const ready = loader.takeReady();
+			if(ready.empty()) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				continue;
+			}
+			for(auto const a : ready) {
+				auto const begin = std::chrono::steady_clock::now();
+				texture.resize((size_t)a->width * a->height * 4);
+				for(int y = 0; y < a->height; y++) { std::memcpy(texture.data() + (size_t)y * a->width * 4, a->pixels + (size_t)y * a->pitch, (size_t)a->width * 4); }
+				a->image = Png::Image();
+				a->pixels = nullptr;
+				a->uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+			}
+		}
+		loader.printReport(std::cout);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	int const threadNum = argc > 1 ? std::atoi(argv[1]) : 0;
+	std::vector<std::string> paths;
+	for(int i = 2; i < argc; i++) { paths.push_back(argv[i]); }
+	if(paths.empty()) {
+		paths.push_back("img/atlas.png");
+		for(auto const& s : Atlas::sprites) { paths.push_back(std::string("img/") + s.name + ".png"); }
+	}
+
+	std::cout << "one thread:\n";
+	loadAll(paths, 1, nullptr);
+	std::cout << "\n" << (threadNum > 0 ? threadNum : std::max((int)std::thread::hardware_concurrency(), 1)) << " threads:\n";
+	loadAll(paths, threadNum, nullptr);
+
+	TextureCache cache;
+	if(!cache.open("img/textures.cache")) {
+		std::cout << "\nno img/textures.cache; run tools/cook_textures.py to time loading from it\n";
+		return 0;
+	}
+	std::cout << "\none thread, from img/textures.cache:\n";
+	loadAll(paths, 1, &cache);
+	return 0;
+}
@@ -0,0 +1,80 @@
+#include "core/Field.h"
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+
+// Sets off the mine nearest the middle of a field and times the chain reaction,
+// once by explodeMine and once blowing the same mines up one by one (blast radius 0)
+// in the same breadth-first order, as a field without chains would have to.
+// usage: minepanzer_bench_chain_reaction [width] [height] [mines] [seed] [maxRadius]
+namespace {
+	double elapsedMs(std::chrono::steady_clock::time_point const begin) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	/// the mined cell nearest (x, y), or -1.
+	int nearestMine(Field const& field, int const x, int const y) {
+		for(int d = 0; d < std::max(field.getWidth(), field.getHeight()); d++) {
+			for(int dy = -d; dy <= d; dy++) for(int dx = -d; dx <= d; dx++) {
+				int const cx = x + dx, cy = y + dy;
+				if(cx < 0 || cy < 0 || cx >= field.getWidth() || cy >= field.getHeight()) { continue; }
+				if(field.getStatus(cx, cy) == Field::Status::mined) { return cy * field.getWidth() + cx; }
+			}
+		}
+		return -1;
+	}
+
+	/// the cells of the chain from start, breadth first.
+	std::vector<int> chainOrder(Field const& field, int const start, int const radius) {
+		int const width = field.getWidth(), height = field.getHeight();
+		std::vector<bool> seen((size_t)width * height, false);
+		std::vector<int> order(1, start);
+		seen[start] = true;
+		for(size_t i = 0; i < order.size(); i++) {
+			int const x = order[i] % width, y = order[i] / width;
+			for(int ny = std::max(y - radius, 0); ny <= std::min(y + radius, height - 1); ny++) {
+				for(int nx = std::max(x - radius, 0); nx <= std::min(x + radius, width - 1); nx++) {
+					int const c = ny * width + nx;
+					if(!seen[c] && field.getStatus(nx, ny) == Field::Status::mined) {
+						seen[c] = true;
+						order.push_back(c);
+					}
+				}
+			}
+		}
+		return order;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	int const width = argc > 1 ? std::atoi(argv[1]) : 2000;
+	int const height = argc > 2 ? std::atoi(argv[2]) : 2000;
+	int const mineNum = argc > 3 ? std::atoi(argv[3]) : width / 6 * height;
+	uint64_t const seed = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 1;
+	int const maxRadius = argc > 5 ? std::atoi(argv[5]) : 2;
+
+	std::cout << width << "x" << height << ", " << mineNum << " mines, seed " << seed << " (a frame is 16.7 ms)\n";
+	for(int radius = 1; radius <= maxRadius; radius++) {
+		Field chained(width, height, mineNum, seed);
+		Field single = chained;
+		int const start = nearestMine(chained, width / 2, height / 2);
+		if(start < 0) { break; }
+		chained.setBlastRadius(radius);
+		single.setBlastRadius(0);
+
+		auto begin = std::chrono::steady_clock::now();
+		chained.explodeMine(start % width, start / width);
+		double const chainedMs = elapsedMs(begin);
+		auto const& blasts = chained.getBlasts();
+
+		std::vector<int> const order = chainOrder(single, start, radius);
+		begin = std::chrono::steady_clock::now();
+		for(auto const c : order) { single.explodeMine(c % width, c / width); }
+		double const singleMs = elapsedMs(begin);
+
+		std::cout << "  radius " << radius << ": " << blasts.size() << " mines in " << blasts.back().wave + 1 << " waves, "
+			<< chainedMs << " ms (one by one " << singleMs << " ms)" << (blasts.size() == order.size() ? "" : " DIFFERENT CHAIN") << "\n";
+	}
+	return 0;
+}
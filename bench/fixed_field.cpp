@@ -0,0 +1,78 @@
+#include "core/Field.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+// Plays the same games on Field and on FixedField of the sizes instantiated in
+// Field.cpp, and prints the time per game of each, checking that both end alike.
+// usage: minepanzer_bench_fixed_field [games] [ticksPerGame] [seed]
+namespace {
+	/// FNV-1a over the state of every cell.
+	template<class F> uint64_t hashField(F const& field) {
+		uint64_t h = 0xCBF29CE484222325ULL;
+		for(int y = 0; y < field.getHeight(); y++) for(int x = 0; x < field.getWidth(); x++) {
+			auto const c = field.getCell(x, y);
+			int const v = ((int)c.status << 6) | (c.neighborMineNum << 2) | (c.isOpenedByFriend << 1) | (int)c.isOpenedByEnemy;
+			h = (h ^ (uint64_t)v) * 0x100000001B3ULL;
+		}
+		return h;
+	}
+
+	struct Result {
+		double buildUs, playUs;
+		uint64_t hash;
+	};
+
+	/// build a field per game and open a cell per tick, at positions from a fixed LCG.
+	template<class F> Result play(int const width, int const height, int const mineNum, int const games, int const ticksPerGame, uint64_t const seed) {
+		Result r = {0, 0, 0};
+		uint64_t lcg = seed;
+		auto const nextCell = [&](int const n) {
+			lcg = lcg * 6364136223846793005ULL + 1442695040888963407ULL;
+			return (int)((lcg >> 33) % (uint64_t)n);
+		};
+		for(int g = 0; g < games; g++) {
+			auto const begin = std::chrono::steady_clock::now();
+			F field(width, height, mineNum, seed + g);
+			auto const built = std::chrono::steady_clock::now();
+			for(int t = 0; t < ticksPerGame; t++) {
+				field.openCell(nextCell(width), nextCell(height), (t & 1) == 0);
+				field.tick();
+				field.clearDirtyCells();
+			}
+			auto const end = std::chrono::steady_clock::now();
+			r.buildUs += std::chrono::duration<double, std::micro>(built - begin).count();
+			r.playUs += std::chrono::duration<double, std::micro>(end - built).count();
+			r.hash = r.hash * 31 + hashField(field);
+		}
+		r.buildUs /= games;
+		r.playUs /= games;
+		return r;
+	}
+
+	template<int W, int H> void compare(int const mineNum, int const games, int const ticksPerGame, uint64_t const seed) {
+		// warm up, then measure
+		play<Field>(W, H, mineNum, games / 10 + 1, ticksPerGame, seed);
+		Result const runtime = play<Field>(W, H, mineNum, games, ticksPerGame, seed);
+		play<FixedField<W, H>>(W, H, mineNum, games / 10 + 1, ticksPerGame, seed);
+		Result const fixed = play<FixedField<W, H>>(W, H, mineNum, games, ticksPerGame, seed);
+
+		std::cout << W << "x" << H << ", " << mineNum << " mines, us per game:\n"
+			<< "  Field:      build " << runtime.buildUs << ", play " << runtime.playUs << "\n"
+			<< "  FixedField: build " << fixed.buildUs << ", play " << fixed.playUs
+			<< " (x" << (runtime.buildUs + runtime.playUs) / (fixed.buildUs + fixed.playUs) << ")"
+			<< (fixed.hash == runtime.hash ? "" : " DIFFERENT GAMES") << "\n";
+	}
+}
+
+int main(int argc, char *argv[]) {
+	int const games = argc > 1 ? std::atoi(argv[1]) : 20000;
+	int const ticksPerGame = argc > 2 ? std::atoi(argv[2]) : 60;
+	uint64_t const seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1;
+
+	compare<9, 9>(10, games, ticksPerGame, seed);
+	compare<16, 16>(40, games, ticksPerGame, seed);
+	compare<30, 16>(99, games, ticksPerGame, seed);
+	compare<64, 64>(410, games / 4, ticksPerGame, seed);
+	return 0;
+}
@@ -0,0 +1,46 @@
+#include "core/Field.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Builds the same field with 1, 2, 4, ... threads and prints the time of each
+// phase, checking that every thread count gives the same field.
+// usage: minepanzer_bench_generation [width] [height] [mines] [seed] [maxThreads]
+namespace {
+	/// FNV-1a over the mines and counts of every cell.
+	uint64_t hashField(Field const& field) {
+		uint64_t h = 0xCBF29CE484222325ULL;
+		for(int y = 0; y < field.getHeight(); y++) for(int x = 0; x < field.getWidth(); x++) {
+			int const v = (field.getStatus(x, y) == Field::Status::mined ? 16 : 0) | field.getNeighborMineNum(x, y);
+			h = (h ^ (uint64_t)v) * 0x100000001B3ULL;
+		}
+		return h;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	int const width = argc > 1 ? std::atoi(argv[1]) : 8192;
+	int const height = argc > 2 ? std::atoi(argv[2]) : 8192;
+	int const mineNum = argc > 3 ? std::atoi(argv[3]) : width / 5 * height;
+	uint64_t const seed = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 1;
+	int const maxThreads = argc > 5 ? std::atoi(argv[5]) : (int)std::max(std::thread::hardware_concurrency(), 1u);
+
+	std::cout << width << "x" << height << ", " << mineNum << " mines, seed " << seed << "\n";
+	uint64_t expected = 0;
+	std::vector<int> threadNums;
+	for(int threads = 1; threads < maxThreads; threads *= 2) { threadNums.push_back(threads); }
+	threadNums.push_back(maxThreads);
+	for(auto const threads : threadNums) {
+		auto const begin = std::chrono::steady_clock::now();
+		Field const field(width, height, mineNum, seed, std::vector<CellRect>(), threads);
+		double const ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+		auto const& t = field.getGenerationTimes();
+		uint64_t const hash = hashField(field);
+		if(threads == 1) { expected = hash; }
+		std::cout << "  " << threads << " threads: " << ms << " ms (plan " << t.planMs << ", place " << t.placeMs << ", count " << t.countMs
+			<< ", allocate " << ms - t.planMs - t.placeMs - t.countMs << ")" << (hash == expected ? "" : " DIFFERENT FIELD") << "\n";
+	}
+	return 0;
+}
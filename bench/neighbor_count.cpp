@@ -0,0 +1,68 @@
+#include "core/Field.h"
+#include "core/NeighborCount.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// Neighbor counts for a freshly mined field: laying the mines one by one against
+// one bulk recount per kernel.
+// usage: minepanzer_bench_neighbor_count [width] [height] [mines] [repeats]
+namespace {
+	double elapsedMs(std::chrono::steady_clock::time_point const begin) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	long long countMismatches(Field const& a, Field const& b) {
+		long long n = 0;
+		for(int y = 0; y < a.getHeight(); y++) for(int x = 0; x < a.getWidth(); x++) {
+			if(a.getNeighborMineNum(x, y) != b.getNeighborMineNum(x, y)) { n++; }
+		}
+		return n;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	int const width = argc > 1 ? std::atoi(argv[1]) : 2048;
+	int const height = argc > 2 ? std::atoi(argv[2]) : 2048;
+	int const mineNum = argc > 3 ? std::atoi(argv[3]) : width * height / 5;
+	int const repeats = argc > 4 ? std::atoi(argv[4]) : 10;
+
+	Field field(width, height, mineNum);
+	std::vector<std::pair<int, int>> mines;
+	for(int y = 0; y < height; y++) for(int x = 0; x < width; x++) {
+		if(field.getStatus(x, y) == Field::Status::mined) { mines.emplace_back(x, y); }
+	}
+	std::cout << width << "x" << height << ", " << mines.size() << " mines, best of " << repeats << "\n";
+
+	// the incrementally counted field is the reference for the bulk kernels
+	Field incremental(width, height, 0);
+	double best = 0;
+	for(int r = 0; r < repeats; r++) {
+		incremental = Field(width, height, 0);
+		auto const begin = std::chrono::steady_clock::now();
+		for(auto const& m : mines) { incremental.layMine(m.first, m.second); }
+		double const ms = elapsedMs(begin);
+		if(r == 0 || ms < best) { best = ms; }
+	}
+	std::cout << "  incremental layMine: " << best << " ms\n";
+
+	auto const defaultIsa = NeighborCount::getSelected();
+	for(auto const isa : {NeighborCount::Isa::scalar, NeighborCount::Isa::sse2, NeighborCount::Isa::avx2}) {
+		if(!NeighborCount::select(isa)) {
+			std::cout << "  bulk " << NeighborCount::getName(isa) << ": not supported\n";
+			continue;
+		}
+		for(int r = 0; r < repeats; r++) {
+			auto const begin = std::chrono::steady_clock::now();
+			field.recountNeighborMines();
+			double const ms = elapsedMs(begin);
+			if(r == 0 || ms < best) { best = ms; }
+		}
+		std::cout << "  bulk " << NeighborCount::getName(isa) << (isa == defaultIsa ? " (default)" : "") << ": " << best << " ms, "
+			<< countMismatches(field, incremental) << " mismatches\n";
+	}
+	NeighborCount::select(defaultIsa);
+	return 0;
+}
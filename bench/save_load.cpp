@@ -0,0 +1,69 @@
+#include "core/Field.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Saves a field, then writes as many bytes in one go to the same path, and loads
+// the field back, timing each and checking that the loaded field is the saved one.
+// usage: minepanzer_bench_save_load [width] [height] [mines] [path]
+namespace {
+	double elapsedMs(std::chrono::steady_clock::time_point const begin) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	/// FNV-1a over the state of every cell.
+	uint64_t hashField(Field const& field) {
+		uint64_t h = 0xCBF29CE484222325ULL;
+		for(int y = 0; y < field.getHeight(); y++) for(int x = 0; x < field.getWidth(); x++) {
+			auto const c = field.getCell(x, y);
+			int const v = ((int)c.status << 6) | (c.neighborMineNum << 2) | (c.isOpenedByFriend << 1) | (int)c.isOpenedByEnemy;
+			h = (h ^ (uint64_t)v) * 0x100000001B3ULL;
+		}
+		return h;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	int const width = argc > 1 ? std::atoi(argv[1]) : 4096;
+	int const height = argc > 2 ? std::atoi(argv[2]) : 4096;
+	int const mineNum = argc > 3 ? std::atoi(argv[3]) : width * height / 8;
+	char const* path = argc > 4 ? argv[4] : "minepanzer_bench.field";
+
+	Field field(width, height, mineNum, 1);
+	for(int i = 0; i < 64; i++) { field.openCell(i * 61 % width, i * 97 % height, (i & 1) == 0); }
+	field.tick();
+
+	auto begin = std::chrono::steady_clock::now();
+	if(!field.save(path)) {
+		std::cerr << "cannot write " << path << "\n";
+		return 1;
+	}
+	double const saveMs = elapsedMs(begin);
+
+	std::FILE* file = std::fopen(path, "rb");
+	std::fseek(file, 0, SEEK_END);
+	long const bytes = std::ftell(file);
+	std::fclose(file);
+
+	std::vector<char> const raw((size_t)bytes, 1);
+	begin = std::chrono::steady_clock::now();
+	file = std::fopen(path, "wb");
+	std::fwrite(raw.data(), 1, raw.size(), file);
+	std::fclose(file);
+	double const writeMs = elapsedMs(begin);
+	field.save(path);
+
+	Field loaded(1, 1, 0, 1);
+	begin = std::chrono::steady_clock::now();
+	bool const isLoaded = loaded.load(path);
+	double const loadMs = elapsedMs(begin);
+	bool const isSame = isLoaded && hashField(loaded) == hashField(field);
+	std::remove(path);
+
+	std::cout << width << "x" << height << ", " << mineNum << " mines: " << bytes / 1024 << " KiB\n"
+		<< "  save " << saveMs << " ms (one write of as many bytes " << writeMs << " ms)\n"
+		<< "  load " << loadMs << " ms" << (isSame ? "" : " NOT THE SAVED FIELD") << "\n";
+	return 0;
+}
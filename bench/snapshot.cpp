@@ -0,0 +1,64 @@
+#include "core/Field.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+// Takes a snapshot, plays a few moves on the field and restores the snapshot, over
+// and over, as a lookahead or a rollback would. Prints the time of each step per
+// cycle, checking now and then that the field comes back as it was.
+// usage: minepanzer_bench_snapshot [cycles] [movesPerCycle] [width] [height] [mines] [seed]
+namespace {
+	/// FNV-1a over the state of every cell.
+	uint64_t hashField(Field const& field) {
+		uint64_t h = 0xCBF29CE484222325ULL;
+		for(int y = 0; y < field.getHeight(); y++) for(int x = 0; x < field.getWidth(); x++) {
+			auto const c = field.getCell(x, y);
+			int const v = ((int)c.status << 6) | (c.neighborMineNum << 2) | (c.isOpenedByFriend << 1) | (int)c.isOpenedByEnemy;
+			h = (h ^ (uint64_t)v) * 0x100000001B3ULL;
+		}
+		return h;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	int const cycles = argc > 1 ? std::atoi(argv[1]) : 10000;
+	int const movesPerCycle = argc > 2 ? std::atoi(argv[2]) : 4;
+	int const width = argc > 3 ? std::atoi(argv[3]) : 512;
+	int const height = argc > 4 ? std::atoi(argv[4]) : 512;
+	int const mineNum = argc > 5 ? std::atoi(argv[5]) : width * height / 8;
+	uint64_t const seed = argc > 6 ? std::strtoull(argv[6], nullptr, 10) : 1;
+
+	Field field(width, height, mineNum, seed);
+	uint64_t const expected = hashField(field);
+	uint64_t lcg = seed;
+	auto const nextCell = [&](int const n) {
+		lcg = lcg * 6364136223846793005ULL + 1442695040888963407ULL;
+		return (int)((lcg >> 33) % (uint64_t)n);
+	};
+
+	double snapshotMs = 0, playMs = 0, restoreMs = 0;
+	int mismatches = 0;
+	for(int c = 0; c < cycles; c++) {
+		auto const begin = std::chrono::steady_clock::now();
+		Field const snapshot = field.snapshot();
+		auto const taken = std::chrono::steady_clock::now();
+		for(int m = 0; m < movesPerCycle; m++) {
+			field.openCell(nextCell(width), nextCell(height), (m & 1) == 0);
+			field.tick();
+		}
+		auto const played = std::chrono::steady_clock::now();
+		field.restore(snapshot);
+		auto const end = std::chrono::steady_clock::now();
+
+		snapshotMs += std::chrono::duration<double, std::milli>(taken - begin).count();
+		playMs += std::chrono::duration<double, std::milli>(played - taken).count();
+		restoreMs += std::chrono::duration<double, std::milli>(end - played).count();
+		if(c % 1000 == 0 && hashField(field) != expected) { mismatches++; }
+	}
+
+	std::cout << width << "x" << height << ", " << mineNum << " mines: " << cycles << " cycles of snapshot, " << movesPerCycle << " moves, restore\n"
+		<< "  per cycle: snapshot " << snapshotMs * 1000.0 / cycles << " us, moves " << playMs * 1000.0 / cycles << " us, restore "
+		<< restoreMs * 1000.0 / cycles << " us" << (mismatches == 0 ? "" : " FIELD NOT RESTORED") << "\n"
+		<< "  all " << cycles << " cycles: " << snapshotMs + playMs + restoreMs << " ms\n";
+	return 0;
+}
@@ -0,0 +1,290 @@
+#include "core/Field.h"
+#include "core/GameSession.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// The hot paths of the field on a grid of board sizes and mine densities, printed as
+// JSON, one benchmark per line:
+//   construct  Field(width, height, mines, seed)
+//   layMine    laying the mines one by one on an empty field
+//   explodeMine  one mine blowing up, blast radius 0 (no chain)
+//   openCell   opening a numbered cell
+//   cascade    opening an empty cell and its whole region
+//   frame      GameSession::step, the per-frame work of GameScene::OnUpdating
+// Each is timed over several samples of 20 ms or more on fresh fields; the median ns
+// per operation is reported. With --baseline, every result is compared with the saved one and the
+// run fails if any is slower by more than the threshold.
+// usage: minepanzer_bench [--sizes 64x64,512x512,2048x2048] [--densities 0.1,0.2]
+//                         [--samples 5] [--seed 1] [--out results.json]
+//                         [--baseline baseline.json] [--threshold 0.15]
+namespace {
+	struct Size2D {
+		int width, height;
+	};
+
+	struct Result {
+		std::string name;
+		double nsPerOp;
+		long long ops;
+	};
+
+	struct Options {
+		std::vector<Size2D> sizes;
+		std::vector<double> densities;
+		int samples = 5;
+		uint64_t seed = 1;
+		std::string outPath, baselinePath;
+		double threshold = 0.15;
+	};
+
+	double elapsedNs(std::chrono::steady_clock::time_point const begin) {
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	/// a cheap LCG for cell positions, so the runs are repeatable.
+	class Positions {
+		uint64_t state;
+	public:
+		Positions(uint64_t const seed) : state(seed) {}
+		int next(int const n) {
+			state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+			return (int)((state >> 33) % (uint64_t)n);
+		}
+	};
+
+	/// a sample is timed over this much work at least, to keep the noise down
+	const double minSampleNs = 20e6;
+
+	/// the median over samples of ns per operation. run does its own untimed setup
+	/// and returns the time and the operation count; a sample calls it until it has
+	/// taken minSampleNs.
+	Result measure(std::string const& name, int const samples, std::function<std::pair<double, long long>(int)> const& run) {
+		std::vector<double> nsPerOp;
+		long long ops = 0;
+		run(-1);	// warm up
+		for(int s = 0, call = 0; s < samples; s++) {
+			double ns = 0;
+			long long sampleOps = 0;
+			while(ns < minSampleNs) {
+				auto const r = run(call++);
+				if(r.second == 0) { break; }
+				ns += r.first;
+				sampleOps += r.second;
+			}
+			if(sampleOps == 0) { continue; }
+			nsPerOp.push_back(ns / sampleOps);
+			ops += sampleOps;
+		}
+		std::sort(nsPerOp.begin(), nsPerOp.end());
+		Result result = {name, nsPerOp.empty() ? 0.0 : nsPerOp[nsPerOp.size() / 2], ops};
+		std::cerr << "  " << result.name << ": " << result.nsPerOp << " ns\n";
+		return result;
+	}
+
+	/// the cells of the field for which pick is true, shuffled, at most maxNum.
+	std::vector<int> pickCells(Field const& field, std::function<bool(int, int)> const& pick, size_t const maxNum, uint64_t const seed) {
+		std::vector<int> cells;
+		for(int y = 0; y < field.getHeight(); y++) for(int x = 0; x < field.getWidth(); x++) {
+			if(pick(x, y)) { cells.push_back(y * field.getWidth() + x); }
+		}
+		Positions positions(seed);
+		for(size_t i = cells.size(); i > 1; i--) { std::swap(cells[i - 1], cells[positions.next((int)i)]); }
+		if(cells.size() > maxNum) { cells.resize(maxNum); }
+		return cells;
+	}
+
+	void benchBoard(Options const& o, Size2D const& size, double const density, std::vector<Result>& results) {
+		int const w = size.width, h = size.height;
+		int const mineNum = (int)(density * w * h);
+		std::ostringstream suffix;
+		suffix << "/" << w << "x" << h << "/" << density;
+		results.push_back(measure("construct" + suffix.str(), o.samples, [&](int const s) {
+			auto const begin = std::chrono::steady_clock::now();
+			Field field(w, h, mineNum, o.seed + s);
+			return std::make_pair(elapsedNs(begin), 1LL);
+		}));
+
+		results.push_back(measure("layMine" + suffix.str(), o.samples, [&](int const s) {
+			Field field(w, h, 0, o.seed);
+			Positions positions(o.seed + s);
+			std::vector<int> cells;
+			for(int i = 0; i < mineNum; i++) { cells.push_back(positions.next(w * h)); }
+			auto const begin = std::chrono::steady_clock::now();
+			for(auto const c : cells) { field.layMine(c % w, c / w); }
+			return std::make_pair(elapsedNs(begin), (long long)cells.size());
+		}));
+
+		results.push_back(measure("explodeMine" + suffix.str(), o.samples, [&](int const s) {
+			Field field(w, h, mineNum, o.seed + s);
+			field.setBlastRadius(0);
+			auto const cells = pickCells(field, [&](int const x, int const y) { return field.getStatus(x, y) == Field::Status::mined; }, 10000, o.seed + s);
+			auto const begin = std::chrono::steady_clock::now();
+			for(auto const c : cells) { field.explodeMine(c % w, c / w); }
+			return std::make_pair(elapsedNs(begin), (long long)cells.size());
+		}));
+
+		results.push_back(measure("openCell" + suffix.str(), o.samples, [&](int const s) {
+			Field field(w, h, mineNum, o.seed + s);
+			auto const cells = pickCells(field, [&](int const x, int const y) {
+				return field.getStatus(x, y) == Field::Status::free && field.getNeighborMineNum(x, y) > 0;
+			}, 10000, o.seed + s);
+			auto const begin = std::chrono::steady_clock::now();
+			for(auto const c : cells) {
+				field.openCell(c % w, c / w, true);
+				field.clearDirtyCells();
+			}
+			return std::make_pair(elapsedNs(begin), (long long)cells.size());
+		}));
+
+		// the empty cells in random order; a cell already opened by an earlier cascade
+		// is skipped untimed, so each one timed opens a region of its own
+		results.push_back(measure("cascade" + suffix.str(), o.samples, [&](int const s) {
+			Field field(w, h, mineNum, o.seed + s);
+			auto const cells = pickCells(field, [&](int const x, int const y) {
+				return field.getStatus(x, y) == Field::Status::free && field.getNeighborMineNum(x, y) == 0;
+			}, (size_t)-1, o.seed + s);
+			double ns = 0;
+			long long cascades = 0;
+			for(auto const c : cells) {
+				if(field.isOpenedByFriend(c % w, c / w)) { continue; }
+				auto const begin = std::chrono::steady_clock::now();
+				field.openCell(c % w, c / w, true);
+				field.clearDirtyCells();
+				ns += elapsedNs(begin);
+				if(++cascades == 1000) { break; }
+			}
+			return std::make_pair(ns, cascades);
+		}));
+	}
+
+	void benchFrames(Options const& o, double const density, std::vector<Result>& results) {
+		int const minesPerChunk = (int)(density * ChunkedWorld::chunkSize * ChunkedWorld::chunkSize);
+		std::ostringstream name;
+		name << "frame/" << density;
+		// drive across the world, turning every few seconds, so chunks load and evict
+		results.push_back(measure(name.str(), o.samples, [&](int const s) {
+			GameSession session(o.seed + s, minesPerChunk, 64);
+			int const frameNum = 60 * 60 * 5;
+			auto const begin = std::chrono::steady_clock::now();
+			for(int f = 0; f < frameNum; f++) { session.step((f / 300) % 2 == 0 ? Tank::keyRight : Tank::keyDown | Tank::keyRight); }
+			return std::make_pair(elapsedNs(begin), (long long)frameNum);
+		}));
+	}
+
+	void writeJson(std::ostream& out, std::vector<Result> const& results) {
+		out << "{\n\t\"suite\": \"minepanzer_bench\",\n\t\"benchmarks\": [\n";
+		for(size_t i = 0; i < results.size(); i++) {
+			out << "\t\t{\"name\": \"" << results[i].name << "\", \"ns_per_op\": " << results[i].nsPerOp << ", \"ops\": " << results[i].ops << "}"
+				<< (i + 1 < results.size() ? "," : "") << "\n";
+		}
+		out << "\t]\n}\n";
+	}
+
+	/// the results in a file writeJson wrote, by name.
+	bool readJson(std::string const& path, std::vector<Result>& results) {
+		std::ifstream in(path);
+		if(!in) { return false; }
+		std::stringstream text;
+		text << in.rdbuf();
+		std::string const s = text.str();
+		for(size_t p = s.find("\"name\": \""); p != std::string::npos; p = s.find("\"name\": \"", p)) {
+			p += 9;
+			size_t const nameEnd = s.find('"', p);
+			size_t const value = s.find("\"ns_per_op\": ", nameEnd);
+			if(nameEnd == std::string::npos || value == std::string::npos) { return false; }
+			Result r = {s.substr(p, nameEnd - p), std::strtod(s.c_str() + value + 13, nullptr), 0};
+			results.push_back(r);
+		}
+		return true;
+	}
+
+	/// print how each result compares with the baseline.
+	/// @return the number of results slower than the baseline by more than the threshold
+	int compare(std::vector<Result> const& results, std::vector<Result> const& baseline, double const threshold) {
+		int regressions = 0;
+		for(auto const& r : results) {
+			auto const b = std::find_if(baseline.begin(), baseline.end(), [&](Result const& x) { return x.name == r.name; });
+			if(b == baseline.end() || b->nsPerOp <= 0) {
+				std::cerr << "  " << r.name << ": not in the baseline\n";
+				continue;
+			}
+			double const ratio = r.nsPerOp / b->nsPerOp;
+			bool const isRegression = ratio > 1.0 + threshold;
+			if(isRegression) { regressions++; }
+			std::cerr << "  " << r.name << ": " << b->nsPerOp << " -> " << r.nsPerOp << " ns (" << (ratio - 1.0) * 100.0 << "%)"
+				<< (isRegression ? " REGRESSION" : ratio < 1.0 - threshold ? " faster" : "") << "\n";
+		}
+		return regressions;
+	}
+
+	template<class T> std::vector<T> parseList(char const* text, std::function<T(std::string const&)> const& parse) {
+		std::vector<T> items;
+		std::stringstream in(text);
+		for(std::string item; std::getline(in, item, ',');) { items.push_back(parse(item)); }
+		return items;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	Options o;
+	o.sizes = {Size2D{64, 64}, Size2D{512, 512}, Size2D{2048, 2048}};
+	o.densities = {0.1, 0.2};
+	for(int i = 1; i + 1 < argc; i += 2) {
+		std::string const option = argv[i];
+		char const* value = argv[i + 1];
+		if(option == "--sizes") {
+			o.sizes = parseList<Size2D>(value, [](std::string const& s) { return Size2D{std::atoi(s.c_str()), std::atoi(s.c_str() + s.find('x') + 1)}; });
+		} else if(option == "--densities") {
+			o.densities = parseList<double>(value, [](std::string const& s) { return std::atof(s.c_str()); });
+		} else if(option == "--samples") {
+			o.samples = std::max(1, std::atoi(value));
+		} else if(option == "--seed") {
+			o.seed = std::strtoull(value, nullptr, 10);
+		} else if(option == "--out") {
+			o.outPath = value;
+		} else if(option == "--baseline") {
+			o.baselinePath = value;
+		} else if(option == "--threshold") {
+			o.threshold = std::atof(value);
+		} else {
+			std::cerr << "unknown option " << option << "\n";
+			return 2;
+		}
+	}
+
+	std::vector<Result> results;
+	for(auto const& size : o.sizes) for(auto const density : o.densities) {
+		if(size.width <= 0 || size.height <= 0) { continue; }
+		benchBoard(o, size, density, results);
+	}
+	for(auto const density : o.densities) { benchFrames(o, density, results); }
+
+	if(o.outPath.empty()) {
+		writeJson(std::cout, results);
+	} else {
+		std::ofstream out(o.outPath);
+		writeJson(out, results);
+		if(!out) {
+			std::cerr << "cannot write " << o.outPath << "\n";
+			return 1;
+		}
+	}
+
+	if(o.baselinePath.empty()) { return 0; }
+	std::vector<Result> baseline;
+	if(!readJson(o.baselinePath, baseline)) {
+		std::cerr << "cannot read " << o.baselinePath << "\n";
+		return 1;
+	}
+	std::cerr << "against " << o.baselinePath << " (threshold " << o.threshold * 100.0 << "%):\n";
+	int const regressions = compare(results, baseline, o.threshold);
+	std::cerr << regressions << " regressions\n";
+	return regressions == 0 ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+#include "AssetLoader.h"
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+
+namespace {
+	double msSince(std::chrono::steady_clock::time_point const begin) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	/// the whole file, or false if it cannot be read.
+	bool readFile(char const* path, std::vector<uint8_t>& bytes) {
+		std::FILE* f = std::fopen(path, "rb");
+		if(!f) { return false; }
+		bool isRead = std::fseek(f, 0, SEEK_END) == 0;
+		long const size = isRead ? std::ftell(f) : -1;
+		isRead = size >= 0 && std::fseek(f, 0, SEEK_SET) == 0;
+		if(isRead) {
+			bytes.resize((size_t)size);
+			isRead = std::fread(bytes.data(), 1, bytes.size(), f) == bytes.size();
+		}
+		std::fclose(f);
+		return isRead;
+	}
+}
+
+AssetLoader::AssetLoader(std::vector<std::string> const& paths, int const threadNum, TextureCache const* c) : next(0), beginTime(std::chrono::steady_clock::now()), cache(c) {
+	for(auto const& p : paths) {
+		assets.push_back(Asset());
+		assets.back().path = p;
+	}
+	int const n = threadNum > 0 ? threadNum : std::max((int)std::thread::hardware_concurrency(), 1);
+	for(int t = 0; t < std::min(n, (int)assets.size()); t++) { threads.emplace_back(&AssetLoader::work, this); }
+}
+
+AssetLoader::~AssetLoader() {
+	// nothing left to hand out: the workers stop after the asset they are on
+	next = (int)assets.size();
+	for(auto& t : threads) { t.join(); }
+}
+
+void AssetLoader::load(Asset& asset) {
+	auto const begin = std::chrono::steady_clock::now();
+	std::vector<uint8_t> bytes;
+	asset.isRead = readFile(asset.path.c_str(), bytes);
+	asset.fileBytes = bytes.size();
+	asset.readMs = msSince(begin);
+	if(!asset.isRead) { return; }
+
+	auto const decodeBegin = std::chrono::steady_clock::now();
+	TextureCache::Texture cached;
+	if(cache && cache->find(asset.path, bytes.data(), bytes.size(), cached)) {
+		asset.isDecoded = asset.isCached = true;
+		asset.pixels = cached.pixels;
+		asset.width = cached.width;
+		asset.height = cached.height;
+		asset.pitch = cached.pitch;
+	} else if(Png::decode(bytes.data(), bytes.size(), asset.image)) {
+		asset.isDecoded = true;
+		asset.pixels = asset.image.pixels.data();
+		asset.width = asset.image.width;
+		asset.height = asset.image.height;
+		asset.pitch = asset.image.width * 4;
+	} else {
+		asset.image = Png::Image();
+	}
+	asset.decodeMs = msSince(decodeBegin);
+}
+
+void AssetLoader::work() {
+	for(int i = next++; i < (int)assets.size(); i = next++) {
+		load(assets[i]);
+		std::lock_guard<std::mutex> lock(mutex);
+		ready.push_back(i);
+	}
+}
+
+std::vector<AssetLoader::Asset*> AssetLoader::takeReady() {
+	std::vector<int> taken;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		taken.swap(ready);
+	}
+	std::vector<Asset*> r;
+	for(auto const i : taken) { r.push_back(&assets[i]); }
+	takenNum += (int)taken.size();
+	return r;
+}
+
+void AssetLoader::printReport(std::ostream& out) const {
+	double readMs = 0, decodeMs = 0, uploadMs = 0;
+	size_t nameWidth = 5;
+	for(auto const& a : assets) { nameWidth = std::max(nameWidth, a.path.size()); }
+	auto const flags = out.flags();
+	auto const precision = out.precision();
+	out << std::fixed << std::setprecision(1)
+		<< std::left << std::setw((int)nameWidth) << "asset" << std::right << "      KB    read  decode  upload (ms)\n";
+	for(auto const& a : assets) {
+		out << std::left << std::setw((int)nameWidth) << a.path << std::right << std::setw(8) << a.fileBytes / 1024.0
+			<< std::setw(8) << a.readMs << std::setw(8) << a.decodeMs << std::setw(8) << a.uploadMs
+			<< (!a.isRead ? "  not read" : !a.isDecoded ? "  not decoded" : a.isCached ? "  cached" : "") << "\n";
+		readMs += a.readMs;
+		decodeMs += a.decodeMs;
+		uploadMs += a.uploadMs;
+	}
+	out << std::left << std::setw((int)nameWidth) << "all" << std::right << std::setw(16) << readMs << std::setw(8) << decodeMs << std::setw(8) << uploadMs << "\n"
+		<< assets.size() << " assets on " << threads.size() << " threads, loaded in " << msSince(beginTime) << " ms\n";
+	out.flags(flags);
+	out.precision(precision);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "Png.h"
+#include "TextureCache.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// reads and decodes a list of images on worker threads, to upload on the render
+/// thread as they come in (the graphics API wants textures made there). The frames
+/// keep going meanwhile, so a loading screen can be drawn.
+///
+/// With a TextureCache, an image cooked from the file as it is now is not decoded:
+/// its pixels are uploaded from the cache's mapping.
+///
+/// Every asset records how long its read, decode and upload took, for the startup
+/// report; the upload time is set by whoever uploads it.
+class AssetLoader {
+public:
+	struct Asset {
+		std::string path;
+		/// the decoded pixels, until they are uploaded and the uploader drops them
+		Png::Image image;
+		/// the pixels to upload, rows pitch bytes apart: the image's, or in the cache
+		uint8_t const* pixels = nullptr;
+		int width = 0, height = 0, pitch = 0;
+		/// isDecoded: the pixels are there, decoded or from the cache
+		bool isRead = false, isDecoded = false, isCached = false;
+		size_t fileBytes = 0;
+		double readMs = 0, decodeMs = 0, uploadMs = 0;
+	};
+
+private:
+	std::vector<Asset> assets;
+	std::vector<std::thread> threads;
+	std::atomic<int> next;
+	std::chrono::steady_clock::time_point beginTime;
+	TextureCache const* cache;
+
+	std::mutex mutex;
+	/// the assets done on a worker and not taken yet
+	std::vector<int> ready;
+	int takenNum = 0;
+
+	AssetLoader(AssetLoader const&);
+	AssetLoader& operator=(AssetLoader const&);
+
+	void load(Asset& asset);
+	void work();
+
+public:
+	/// start loading the files on threadNum threads (0: one per core), from the cache
+	/// where it has them. The cache must outlive the loader and the uploads.
+	AssetLoader(std::vector<std::string> const& paths, int const threadNum = 0, TextureCache const* cache = nullptr);
+	/// waits for the workers.
+	~AssetLoader();
+
+	/// the assets read and decoded, or failed (isDecoded is false), since the last
+	/// call, in the order they were finished. Render thread only.
+	std::vector<Asset*> takeReady();
+	/// true once every asset has been taken
+	bool isDone() const { return takenNum == (int)assets.size(); }
+	int getTakenNum() const { return takenNum; }
+	int getAssetNum() const { return (int)assets.size(); }
+	int getThreadNum() const { return (int)threads.size(); }
+
+	/// a table of the read, decode and upload times of every asset, and the time
+	/// from the start of loading to now. Once isDone().
+	void printReport(std::ostream& out) const;
+};
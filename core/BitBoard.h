@@ -0,0 +1,134 @@
+#pragma once
+#include "Planes.h"
+
+// Word-parallel operations over BitPlanes: 64 cells of a row are handled per
+// instruction. Bit x of a row word stands for column 64 * wi + x.
+
+namespace BitBoard {
+	/// the row moved one cell east: bit x holds the cell at x - 1.
+	inline uint64_t fromWest(uint64_t const* row, int const wi) {
+		return (row[wi] << 1) | (wi > 0 ? row[wi - 1] >> 63 : 0);
+	}
+
+	/// fromWest for a BitPlane row: at wi = 0 the cell left of the row is read from
+	/// the padding in front of it (bit 63 of the word before), so that cells set on
+	/// the padding ring are seen too.
+	inline uint64_t fromWestPadded(uint64_t const* row, int const wi) {
+		return (row[wi] << 1) | (row[wi - 1] >> 63);
+	}
+
+	/// the row moved one cell west: bit x holds the cell at x + 1.
+	inline uint64_t fromEast(uint64_t const* row, int const wi, int const wordsPerRow) {
+		return (row[wi] >> 1) | (wi + 1 < wordsPerRow ? row[wi + 1] << 63 : 0);
+	}
+
+	/// the row grown by one cell to the east and west.
+	inline uint64_t widen(uint64_t const* row, int const wi, int const wordsPerRow) {
+		return row[wi] | fromWest(row, wi) | fromEast(row, wi, wordsPerRow);
+	}
+
+	/// grow the set bits of g towards higher bits, through the set bits of p only.
+	inline uint64_t fillTowardsHigh(uint64_t g, uint64_t p) {
+		g |= p & (g << 1);
+		p &= p << 1;
+		g |= p & (g << 2);
+		p &= p << 2;
+		g |= p & (g << 4);
+		p &= p << 4;
+		g |= p & (g << 8);
+		p &= p << 8;
+		g |= p & (g << 16);
+		p &= p << 16;
+		g |= p & (g << 32);
+		return g;
+	}
+
+	/// grow the set bits of g towards lower bits, through the set bits of p only.
+	inline uint64_t fillTowardsLow(uint64_t g, uint64_t p) {
+		g |= p & (g >> 1);
+		p &= p >> 1;
+		g |= p & (g >> 2);
+		p &= p >> 2;
+		g |= p & (g >> 4);
+		p &= p >> 4;
+		g |= p & (g >> 8);
+		p &= p >> 8;
+		g |= p & (g >> 16);
+		p &= p >> 16;
+		g |= p & (g >> 32);
+		return g;
+	}
+
+	/// grow every seed in the row along the run of mask cells it lies on.
+	/// The seeds must lie inside the mask.
+	inline void fillRuns(uint64_t* row, uint64_t const* mask, int const wordsPerRow) {
+		uint64_t carry = 0;
+		for(int wi = 0; wi < wordsPerRow; wi++) {
+			row[wi] = fillTowardsHigh(row[wi] | (carry & mask[wi]), mask[wi]);
+			carry = row[wi] >> 63;
+		}
+		carry = 0;
+		for(int wi = wordsPerRow - 1; wi >= 0; wi--) {
+			row[wi] = fillTowardsLow(row[wi] | ((carry << 63) & mask[wi]), mask[wi]);
+			carry = row[wi] & 1;
+		}
+	}
+
+	inline void halfAdd(uint64_t const a, uint64_t const b, uint64_t& sum, uint64_t& carry) {
+		sum = a ^ b;
+		carry = a & b;
+	}
+
+	inline void fullAdd(uint64_t const a, uint64_t const b, uint64_t const c, uint64_t& sum, uint64_t& carry) {
+		uint64_t const u = a ^ b;
+		sum = u ^ c;
+		carry = (a & b) | (u & c);
+	}
+
+	/// a count from 0 to 8 for 64 cells at once, one bit plane per binary digit.
+	struct Count {
+		uint64_t bit0, bit1, bit2, bit3;
+	};
+
+	/// add up eight one-bit inputs per cell with a carry-save adder tree.
+	inline Count add8(uint64_t const n0, uint64_t const n1, uint64_t const n2, uint64_t const n3,
+		uint64_t const n4, uint64_t const n5, uint64_t const n6, uint64_t const n7) {
+		uint64_t s0, c0, s1, c1, s2, c2, c3, t, d, e;
+		Count r;
+		fullAdd(n0, n1, n2, s0, c0);
+		fullAdd(n3, n4, n5, s1, c1);
+		halfAdd(n6, n7, s2, c2);
+		fullAdd(s0, s1, s2, r.bit0, c3);
+		// c0..c3 are worth 2 each
+		fullAdd(c0, c1, c2, t, d);
+		halfAdd(t, c3, r.bit1, e);
+		// d and e are worth 4 each
+		halfAdd(d, e, r.bit2, r.bit3);
+		return r;
+	}
+
+	/// number of set neighbors for the 64 cells in word wi of the middle row.
+	/// The rows are BitPlane rows: set cells on the padding ring count as neighbors.
+	inline Count countNeighbors(uint64_t const* up, uint64_t const* mid, uint64_t const* down, int const wi, int const wordsPerRow) {
+		return add8(fromWestPadded(up, wi), up[wi], fromEast(up, wi, wordsPerRow),
+			fromWestPadded(mid, wi), fromEast(mid, wi, wordsPerRow),
+			fromWestPadded(down, wi), down[wi], fromEast(down, wi, wordsPerRow));
+	}
+
+	/// spread the 8 bits of b to bits 0, 4, 8, ... 28.
+	inline uint32_t spreadToNibbles(uint32_t b) {
+		b = (b | (b << 12)) & 0x000F000F;
+		b = (b | (b << 6)) & 0x03030303;
+		b = (b | (b << 3)) & 0x11111111;
+		return b;
+	}
+
+	/// the counts of cells 8 * g .. 8 * g + 7 of c, cell i in bits 4i..4i+3.
+	inline uint32_t groupNibbles(Count const& c, int const g) {
+		int const shift = g * 8;
+		return spreadToNibbles((uint32_t)(c.bit0 >> shift) & 0xFF)
+			| spreadToNibbles((uint32_t)(c.bit1 >> shift) & 0xFF) << 1
+			| spreadToNibbles((uint32_t)(c.bit2 >> shift) & 0xFF) << 2
+			| spreadToNibbles((uint32_t)(c.bit3 >> shift) & 0xFF) << 3;
+	}
+}
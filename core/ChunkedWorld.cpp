@@ -0,0 +1,239 @@
+#include "ChunkedWorld.h"
+#include "CounterRng.h"
+#include <algorithm>
+
+namespace {
+	struct Offset {
+		int dx, dy;
+	};
+
+	/// the eight chunks around a chunk
+	Offset const neighborOffsets[] = {
+		{-1, -1}, {0, -1}, {1, -1},
+		{-1, 0}, {1, 0},
+		{-1, 1}, {0, 1}, {1, 1}
+	};
+
+	/// one step of FNV-1a, a value at a time.
+	uint64_t hashMix(uint64_t const h, uint64_t const v) { return (h ^ v) * 0x100000001B3ULL; }
+}
+
+ChunkedWorld::ChunkedWorld(uint64_t const s, int const m, int const maxResident, std::vector<CellRect> const& zones) :
+	seed(s), minesPerChunk(m), maxResidentChunks(maxResident), safeZones(zones) {}
+
+std::unique_ptr<ChunkedWorld::ChunkField> ChunkedWorld::buildChunk(int const cx, int const cy) const {
+	std::vector<CellRect> zones;
+	for(auto const& z : safeZones) { zones.push_back(CellRect{z.x - cx * chunkSize, z.y - cy * chunkSize, z.width, z.height}); }
+
+	auto const key = keyOf(cx, cy);
+	auto const s = stored.find(key);
+	uint64_t const chunkSeed = CounterRng(seed, key).next();
+	std::unique_ptr<ChunkField> field(new ChunkField(chunkSize, chunkSize, s == stored.end() ? minesPerChunk : 0, chunkSeed, zones));
+	if(s != stored.end()) { field->loadCompact(s->second); }
+	field->setBlastRadius(blastRadius);
+	return field;
+}
+
+void ChunkedWorld::copyRing(ChunkField& dst, ChunkField const& src, int const dx, int const dy) {
+	// the ring cells of dst on that side: a corner cell, or a whole row or column
+	int const x0 = dx < 0 ? -1 : dx > 0 ? chunkSize : 0, x1 = dx == 0 ? chunkSize : x0 + 1;
+	int const y0 = dy < 0 ? -1 : dy > 0 ? chunkSize : 0, y1 = dy == 0 ? chunkSize : y0 + 1;
+	for(int y = y0; y < y1; y++) for(int x = x0; x < x1; x++) {
+		dst.setOuterMine(x, y, src.getStatus(x - dx * chunkSize, y - dy * chunkSize) == ChunkField::Status::mined);
+	}
+}
+
+ChunkedWorld::Chunk& ChunkedWorld::makeResident(int const cx, int const cy) {
+	auto const key = keyOf(cx, cy);
+	auto const r = resident.find(key);
+	if(r != resident.end()) { return r->second; }
+
+	// the ring takes the mines of the neighbors as they are now: resident, stored or
+	// not built yet (then they are built just to read their edges)
+	auto field = buildChunk(cx, cy);
+	for(auto const& o : neighborOffsets) {
+		auto const n = resident.find(keyOf(cx + o.dx, cy + o.dy));
+		if(n != resident.end()) {
+			copyRing(*field, *n->second.field, o.dx, o.dy);
+		} else {
+			copyRing(*field, *buildChunk(cx + o.dx, cy + o.dy), o.dx, o.dy);
+		}
+	}
+	auto& chunk = resident[key];
+	chunk.field = std::move(field);
+	chunk.lastShown = showCount;
+	chunk.isPlayed = false;
+	loadedChunks.push_back(ChunkPos{cx, cy});
+
+	// empty regions opened next to the seams continue into the new chunk
+	std::vector<uint64_t> keys(1, key);
+	for(auto const& o : neighborOffsets) { keys.push_back(keyOf(cx + o.dx, cy + o.dy)); }
+	syncSeams(keys);
+	return chunk;
+}
+
+void ChunkedWorld::evict(uint64_t const key) {
+	auto const r = resident.find(key);
+	if(r == resident.end()) { return; }
+	if(r->second.isPlayed) {
+		auto& bytes = stored[key];
+		storedBytes -= bytes.size();
+		bytes.clear();
+		r->second.field->saveCompact(bytes);
+		bytes.shrink_to_fit();
+		storedBytes += bytes.size();
+	}
+	resident.erase(r);
+	evictedChunks.push_back(posOf(key));
+}
+
+void ChunkedWorld::syncSeams(std::vector<uint64_t> keys) {
+	while(!keys.empty()) {
+		auto const key = keys.back();
+		keys.pop_back();
+		auto const r = resident.find(key);
+		if(r == resident.end()) { continue; }
+		auto const pos = posOf(key);
+		ChunkField& field = *r->second.field;
+
+		// mines along the edges into the rings of the neighbors
+		for(auto const& o : neighborOffsets) {
+			auto const n = resident.find(keyOf(pos.x + o.dx, pos.y + o.dy));
+			if(n != resident.end()) { copyRing(*n->second.field, field, -o.dx, -o.dy); }
+		}
+
+		// an opened empty cell on the edge opens its neighbors across the seam
+		auto const openAcross = [&](int const x, int const y) {
+			if(field.getStatus(x, y) != ChunkField::Status::free || field.getNeighborMineNum(x, y) != 0) { return; }
+			for(int side = 0; side < 2; side++) {
+				bool const isFriend = side == 0;
+				if(!(isFriend ? field.isOpenedByFriend(x, y) : field.isOpenedByEnemy(x, y))) { continue; }
+				for(auto const& o : neighborOffsets) {
+					int const wx = pos.x * chunkSize + x + o.dx, wy = pos.y * chunkSize + y + o.dy;
+					int const ncx = chunkOf(wx), ncy = chunkOf(wy);
+					if(ncx == pos.x && ncy == pos.y) { continue; }
+					auto const n = resident.find(keyOf(ncx, ncy));
+					if(n == resident.end()) { continue; }
+					ChunkField& other = *n->second.field;
+					int const lx = wx - ncx * chunkSize, ly = wy - ncy * chunkSize;
+					// only cells this opens: a mined, exploding or opened one would be
+					// queued again and again for nothing
+					if(other.getStatus(lx, ly) != ChunkField::Status::free || (isFriend ? other.isOpenedByFriend(lx, ly) : other.isOpenedByEnemy(lx, ly))) { continue; }
+					other.openCell(lx, ly, isFriend);
+					n->second.isPlayed = true;
+					keys.push_back(n->first);
+				}
+			}
+		};
+		for(int x = 0; x < chunkSize; x++) {
+			openAcross(x, 0);
+			openAcross(x, chunkSize - 1);
+		}
+		for(int y = 1; y < chunkSize - 1; y++) {
+			openAcross(0, y);
+			openAcross(chunkSize - 1, y);
+		}
+
+		// a blast near the edge sets off the mines it reaches across the seam, and the
+		// chain goes on in that chunk
+		int const radius = field.getBlastRadius();
+		for(auto const& b : field.getBlasts()) {
+			if(b.x >= radius && b.y >= radius && b.x < chunkSize - radius && b.y < chunkSize - radius) { continue; }
+			for(int dy = -radius; dy <= radius; dy++) for(int dx = -radius; dx <= radius; dx++) {
+				int const wx = pos.x * chunkSize + b.x + dx, wy = pos.y * chunkSize + b.y + dy;
+				int const ncx = chunkOf(wx), ncy = chunkOf(wy);
+				if(ncx == pos.x && ncy == pos.y) { continue; }
+				auto const n = resident.find(keyOf(ncx, ncy));
+				if(n == resident.end()) { continue; }
+				ChunkField& other = *n->second.field;
+				int const lx = wx - ncx * chunkSize, ly = wy - ncy * chunkSize;
+				if(other.getStatus(lx, ly) != ChunkField::Status::mined) { continue; }
+				other.explodeMine(lx, ly);
+				n->second.isPlayed = true;
+				keys.push_back(n->first);
+			}
+		}
+	}
+}
+
+void ChunkedWorld::showArea(CellRect const& area) {
+	showCount++;
+	for(int cy = chunkOf(area.y); cy <= chunkOf(area.y + area.height - 1); cy++) {
+		for(int cx = chunkOf(area.x); cx <= chunkOf(area.x + area.width - 1); cx++) { makeResident(cx, cy).lastShown = showCount; }
+	}
+	if((int)resident.size() <= maxResidentChunks) { return; }
+
+	// the chunks out of sight, least recently shown first. Chunks with explosions
+	// running or opens scheduled stay until they are done.
+	std::vector<std::pair<long long, uint64_t>> candidates;
+	for(auto const& r : resident) {
+		if(r.second.lastShown < showCount && r.second.field->isIdle()) { candidates.emplace_back(r.second.lastShown, r.first); }
+	}
+	std::sort(candidates.begin(), candidates.end());
+	for(size_t i = 0; i < candidates.size() && (int)resident.size() > maxResidentChunks; i++) { evict(candidates[i].second); }
+}
+
+ChunkedWorld::ChunkField* ChunkedWorld::getChunk(int const cx, int const cy) {
+	auto const r = resident.find(keyOf(cx, cy));
+	return r == resident.end() ? nullptr : r->second.field.get();
+}
+
+std::vector<ChunkedWorld::ChunkPos> ChunkedWorld::getResidentChunks() const {
+	std::vector<ChunkPos> chunks;
+	for(auto const& r : resident) { chunks.push_back(posOf(r.first)); }
+	return chunks;
+}
+
+bool ChunkedWorld::openCell(int const x, int const y, bool const isFriend) {
+	int const cx = chunkOf(x), cy = chunkOf(y);
+	auto& chunk = makeResident(cx, cy);
+	chunk.isPlayed = true;
+	bool const isMined = chunk.field->openCell(x - cx * chunkSize, y - cy * chunkSize, isFriend);
+	syncSeams(std::vector<uint64_t>(1, keyOf(cx, cy)));
+	return isMined;
+}
+
+void ChunkedWorld::tick() {
+	std::vector<uint64_t> changed;
+	for(auto& r : resident) {
+		r.second.field->tick();
+		if(r.second.field->getProcessedCellCount() > 0) {
+			r.second.isPlayed = true;
+			changed.push_back(r.first);
+		}
+	}
+	syncSeams(changed);
+}
+
+void ChunkedWorld::setBlastRadius(int const radius) {
+	blastRadius = radius;
+	for(auto& r : resident) { r.second.field->setBlastRadius(radius); }
+}
+
+std::vector<FieldTypes::Blast> ChunkedWorld::getBlasts() const {
+	std::vector<FieldTypes::Blast> blasts;
+	for(auto const& r : resident) {
+		auto const pos = posOf(r.first);
+		for(auto const& b : r.second.field->getBlasts()) { blasts.push_back(FieldTypes::Blast{pos.x * chunkSize + b.x, pos.y * chunkSize + b.y, b.wave}); }
+	}
+	return blasts;
+}
+
+void ChunkedWorld::clearChunkEvents() {
+	loadedChunks.clear();
+	evictedChunks.clear();
+}
+
+uint64_t ChunkedWorld::hashState() const {
+	std::vector<std::pair<uint64_t, uint64_t>> chunks;
+	for(auto const& r : resident) { chunks.emplace_back(r.first, r.second.field->hashState()); }
+	for(auto const& s : stored) {
+		uint64_t h = 0xCBF29CE484222325ULL;
+		for(auto const b : s.second) { h = hashMix(h, b); }
+		chunks.emplace_back(s.first, h);
+	}
+	std::sort(chunks.begin(), chunks.end());
+	uint64_t h = hashMix(0xCBF29CE484222325ULL, resident.size());
+	for(auto const& c : chunks) { h = hashMix(hashMix(h, c.first), c.second); }
+	return h;
+}
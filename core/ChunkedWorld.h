@@ -0,0 +1,114 @@
+#pragma once
+#include "Field.h"
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+/// An unbounded battlefield made of chunkSize x chunkSize fields. A chunk is built
+/// from (seed, chunkX, chunkY) alone the first time it is needed, so the world does
+/// not have to exist beyond what has been looked at.
+///
+/// At most maxResidentChunks chunks are kept as fields; the least recently shown
+/// ones beyond that are evicted. An evicted chunk that was never played on is just
+/// dropped (it can be built again); one that was is kept in the compact form of
+/// Field::saveCompact, a few bytes to a few hundred per chunk.
+///
+/// Chunks see the mines of their neighbors through their padding ring, so counts
+/// along the seams are right, and empty regions and chain reactions that reach a
+/// seam carry on in the resident chunk next to it.
+class ChunkedWorld {
+public:
+	static const int chunkSize = 64;
+	/// a chunk; its size is fixed, so it is a FixedField.
+	typedef FixedField<chunkSize, chunkSize> ChunkField;
+
+	/// a chunk by its coordinates; cell (x, y) of the world lies in chunk
+	/// (floor(x / chunkSize), floor(y / chunkSize)).
+	struct ChunkPos {
+		int x, y;
+	};
+
+private:
+	struct Chunk {
+		std::unique_ptr<ChunkField> field;
+		long long lastShown;
+		bool isPlayed;
+	};
+
+	uint64_t seed;
+	int minesPerChunk, maxResidentChunks;
+	int blastRadius = 1;
+	std::vector<CellRect> safeZones;
+
+	std::unordered_map<uint64_t, Chunk> resident;
+	std::unordered_map<uint64_t, std::vector<uint8_t>> stored;
+	size_t storedBytes = 0;
+	long long showCount = 0;
+
+	// chunks made resident or evicted since the last clearChunkEvents()
+	std::vector<ChunkPos> loadedChunks, evictedChunks;
+
+	static uint64_t keyOf(int const cx, int const cy) { return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy; }
+	static ChunkPos posOf(uint64_t const key) { return ChunkPos{(int)(uint32_t)(key >> 32), (int)(uint32_t)key}; }
+
+	/// the chunk as a field without its neighbors' mines: restored if stored, built otherwise.
+	std::unique_ptr<ChunkField> buildChunk(int const cx, int const cy) const;
+
+	/// copy the mines of src along its side facing dst to the padding ring of dst.
+	/// src is the chunk at (dx, dy) from dst.
+	static void copyRing(ChunkField& dst, ChunkField const& src, int const dx, int const dy);
+
+	Chunk& makeResident(int const cx, int const cy);
+	void evict(uint64_t const key);
+
+	/// copy the mines along the edges of the chunk to the rings of its resident
+	/// neighbors, open across the seams where an opened empty cell touches one, and
+	/// set off the mines across them within reach of a blast. Chunks that changed on
+	/// the way are handled too.
+	void syncSeams(std::vector<uint64_t> keys);
+
+public:
+	/// minesPerChunk mines are laid in every chunk, none inside safeZones (in world cells).
+	ChunkedWorld(uint64_t const seed, int const minesPerChunk, int const maxResidentChunks, std::vector<CellRect> const& safeZones = std::vector<CellRect>());
+
+	uint64_t getSeed() const { return seed; }
+
+	int getBlastRadius() const { return blastRadius; }
+	/// the blast radius of every chunk (see BasicField::setBlastRadius).
+	void setBlastRadius(int const radius);
+
+	static int chunkOf(int const cell) { return cell >= 0 ? cell / chunkSize : (cell + 1) / chunkSize - 1; }
+
+	/// make every chunk overlapping the rect (in world cells) resident, and evict the
+	/// least recently shown chunks beyond maxResidentChunks. Call once per frame.
+	void showArea(CellRect const& area);
+
+	/// the resident chunk, or nullptr.
+	ChunkField* getChunk(int const cx, int const cy);
+	/// the resident chunks, in no particular order.
+	std::vector<ChunkPos> getResidentChunks() const;
+
+	/// open a cell of the world, loading its chunk if needed.
+	/// @return true iff the cell is mined
+	bool openCell(int const x, int const y, bool const isFriend);
+
+	/// tick every resident chunk.
+	void tick();
+
+	/// the mines that blew up in the last tick() and since, in world cells. Waves
+	/// count from where a chain crossed into the chunk.
+	std::vector<FieldTypes::Blast> getBlasts() const;
+
+	/// chunks made resident and evicted since the last clearChunkEvents(), for views.
+	std::vector<ChunkPos> const& getLoadedChunks() const { return loadedChunks; }
+	std::vector<ChunkPos> const& getEvictedChunks() const { return evictedChunks; }
+	void clearChunkEvents();
+
+	size_t getResidentChunkNum() const { return resident.size(); }
+	size_t getStoredChunkNum() const { return stored.size(); }
+	size_t getStoredBytes() const { return storedBytes; }
+
+	/// a hash of the resident chunks (see BasicField::hashState) and the stored ones,
+	/// whatever order they were loaded in.
+	uint64_t hashState() const;
+};
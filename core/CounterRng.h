@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+
+/// counter-based random numbers in the style of SplitMix64: number n of a stream
+/// is a pure function of (seed, stream, n). Streams do not share state, so e.g.
+/// every tile of a map can draw its own numbers on any thread, in any order, and
+/// still get the same ones as a serial run.
+class CounterRng {
+	static const uint64_t gamma = 0x9E3779B97F4A7C15ULL;
+	uint64_t key, counter = 0;
+
+public:
+	/// the SplitMix64 finalizer: a bijective 64-bit mix.
+	static uint64_t mix(uint64_t z) {
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	CounterRng(uint64_t const seed, uint64_t const stream) : key(mix(seed + gamma) ^ mix(stream * gamma + 1)) {}
+
+	/// number n of the stream, without moving the counter.
+	uint64_t at(uint64_t const n) const { return mix(key + n * gamma); }
+
+	uint64_t next() { return at(counter++); }
+
+	/// uniform in [0, n), 0 < n <= 2^32. Lemire's multiply-and-reject: unbiased,
+	/// the same on every platform, and without a division in the common case.
+	uint32_t below(uint64_t const n) {
+		uint64_t m = (uint64_t)(uint32_t)next() * n;
+		if((uint32_t)m < n) {
+			uint32_t const threshold = (uint32_t)((0x100000000ULL - n) % n);
+			while((uint32_t)m < threshold) { m = (uint64_t)(uint32_t)next() * n; }
+		}
+		return (uint32_t)(m >> 32);
+	}
+};
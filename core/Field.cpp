@@ -0,0 +1,690 @@
+#include "Field.h"
+#include "MappedFile.h"
+#include "NeighborCount.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+	struct Offset {
+		int dx, dy;
+	};
+
+	/// the eight neighbors of a cell
+	Offset const neighborOffsets[] = {
+		{-1, -1}, {0, -1}, {1, -1},
+		{-1, 0}, {1, 0},
+		{-1, 1}, {0, 1}, {1, 1}
+	};
+
+	// rows per item of the parallel recount
+	const int rowBand = 64;
+
+	/// the set cells of one word of a BitPlane: row y, word wi.
+	struct WaveWord {
+		int y, wi;
+		uint64_t bits;
+	};
+
+	double elapsedMs(std::chrono::steady_clock::time_point const begin) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	void appendVarint(std::vector<uint8_t>& out, uint32_t v) {
+		for(; v >= 0x80; v >>= 7) { out.push_back((uint8_t)(v | 0x80)); }
+		out.push_back((uint8_t)v);
+	}
+
+	bool readVarint(uint8_t const*& p, uint8_t const* end, uint32_t& v) {
+		v = 0;
+		for(int shift = 0; p != end && shift < 35; shift += 7) {
+			uint8_t const b = *p++;
+			v |= (uint32_t)(b & 0x7F) << shift;
+			if(!(b & 0x80)) { return true; }
+		}
+		return false;
+	}
+
+	/// the cells of the plane inside the field, row by row, as the lengths of
+	/// alternating runs of clear and set cells (starting with a clear run).
+	template<class Plane> void appendRuns(std::vector<uint8_t>& out, Plane const& plane) {
+		bool bit = false;
+		uint32_t run = 0;
+		for(int y = 0; y < plane.getHeight(); y++) for(int x = 0; x < plane.getWidth(); x++) {
+			if(plane.get(x, y) != bit) {
+				appendVarint(out, run);
+				bit = !bit;
+				run = 0;
+			}
+			run++;
+		}
+		appendVarint(out, run);
+	}
+
+	template<class Plane> bool readRuns(uint8_t const*& p, uint8_t const* end, Plane& plane) {
+		long long const cellNum = (long long)plane.getWidth() * plane.getHeight();
+		long long cell = 0;
+		for(bool bit = false; cell < cellNum; bit = !bit) {
+			uint32_t run;
+			if(!readVarint(p, end, run) || cell + run > cellNum) { return false; }
+			for(long long const runEnd = cell + run; cell < runEnd; cell++) {
+				if(bit) { plane.set((int)(cell % plane.getWidth()), (int)(cell / plane.getWidth())); }
+			}
+		}
+		return true;
+	}
+
+	/// The file format of BasicField::save. Numbers are in the byte order of the
+	/// machine that wrote the file (a reader checks byteOrder), since the planes are
+	/// used as they are:
+	///
+	///   FileHeader
+	///   the scheduled opens: scheduledNum cells y * width + x, uint32_t each
+	///   the running explosions: detonationNum pairs of int64_t (cell, endTick)
+	///   zeros up to planesOffset, a multiple of 64
+	///   the bit planes of SavedPlane, in that order, then the neighbor counts.
+	///   Each is its rows -1 .. height, guard words or cells included, padded
+	///   with zero rows to whole pages of 2^pageRowShift rows (see Storage).
+	///
+	/// The opened and to-open planes hold the cells each side opened or is to open.
+	/// A change to any of it bumps fileVersion.
+	struct FileHeader {
+		char magic[8];
+		uint32_t version, byteOrder;
+		int32_t width, height, mineNum, blastRadius;
+		uint64_t seed;
+		int64_t tickCount;
+		uint32_t scheduledNum, detonationNum;
+		uint64_t planesOffset;
+	};
+
+	char const fileMagic[8] = {'M', 'P', 'F', 'I', 'E', 'L', 'D', 0};
+	const uint32_t fileVersion = 1;
+	const uint32_t fileByteOrder = 0x01020304;
+
+	enum SavedPlane {
+		savedMined, savedObstacle, savedExploding,
+		savedOpenedByFriend, savedOpenedByEnemy, savedToOpenByFriend, savedToOpenByEnemy,
+		savedZeros,
+		savedBitPlaneNum
+	};
+
+	/// rows of a plane in a file
+	int savedRowNum(int const height) { return (height + 2 + (1 << pageRowShift) - 1) & ~((1 << pageRowShift) - 1); }
+	size_t savedBitPlaneBytes(int const width, int const height) { return (size_t)savedRowNum(height) * BitPlane::rowWordsFor(width) * 8; }
+	size_t savedNibblePlaneBytes(int const width, int const height) { return (size_t)savedRowNum(height) * NibblePlane::rowBytesFor(width); }
+
+	/// write the rows of the plane, rowSize bytes each, and the zero rows after them.
+	template<class Plane> bool writePlane(std::FILE* file, Plane const& plane, size_t const rowSize) {
+		bool ok = true;
+		plane.forEachRun([&](void const* rows, int const n) { ok = ok && std::fwrite(rows, rowSize, n, file) == (size_t)n; });
+		std::vector<uint8_t> const zeroRows(rowSize * (savedRowNum(plane.getHeight()) - plane.getHeight() - 2), 0);
+		return ok && std::fwrite(zeroRows.data(), 1, zeroRows.size(), file) == zeroRows.size();
+	}
+
+	/// one step of FNV-1a, a value at a time.
+	uint64_t hashMix(uint64_t const h, uint64_t const v) { return (h ^ v) * 0x100000001B3ULL; }
+
+	uint64_t randomSeed() {
+		std::random_device rnd;
+		return ((uint64_t)rnd() << 32) | rnd();
+	}
+}
+
+template<class Size> BasicField<Size>::BasicField(int const w, int const h, int const m, std::vector<CellRect> const& safeZones) :
+	BasicField(w, h, m, randomSeed(), safeZones) {}
+
+template<class Size> BasicField<Size>::BasicField(int const w, int const h, uint8_t* planes, std::shared_ptr<void> const& owner) :
+	Size(w, h),
+	mined(w, h, (uint64_t*)(planes + savedMined * savedBitPlaneBytes(w, h)), owner),
+	obstacle(w, h, (uint64_t*)(planes + savedObstacle * savedBitPlaneBytes(w, h)), owner),
+	exploding(w, h, (uint64_t*)(planes + savedExploding * savedBitPlaneBytes(w, h)), owner),
+	neighborMineNums(w, h, planes + savedBitPlaneNum * savedBitPlaneBytes(w, h), owner),
+	openedByFriend(w, h, (uint64_t*)(planes + savedOpenedByFriend * savedBitPlaneBytes(w, h)), owner),
+	openedByEnemy(w, h, (uint64_t*)(planes + savedOpenedByEnemy * savedBitPlaneBytes(w, h)), owner),
+	toOpenByFriend(w, h, (uint64_t*)(planes + savedToOpenByFriend * savedBitPlaneBytes(w, h)), owner),
+	toOpenByEnemy(w, h, (uint64_t*)(planes + savedToOpenByEnemy * savedBitPlaneBytes(w, h)), owner),
+	dirty(w, h),
+	mineNum(0), seed(0),
+	zeros(w, h, (uint64_t*)(planes + savedZeros * savedBitPlaneBytes(w, h)), owner), revealRegion(w, h) {}
+
+template<class Size> BasicField<Size>::BasicField(int const w, int const h, int const m, uint64_t const s, std::vector<CellRect> const& safeZones, int const threadNum) :
+	Size(w, h), mined(w, h), obstacle(w, h), exploding(w, h),
+	neighborMineNums(w, h),
+	openedByFriend(w, h), openedByEnemy(w, h),
+	toOpenByFriend(w, h), toOpenByEnemy(w, h),
+	dirty(w, h),
+	mineNum(0), seed(s),
+	zeros(w, h), revealRegion(w, h) {
+
+	// the padding ring is a wall of obstacles: never free, never opened, never a zero
+	obstacle.setPadding();
+
+	// lay all the mines tile by tile, then count them in one pass. Neither phase
+	// depends on which thread does what, so the field is the same for any threadNum.
+	auto begin = std::chrono::steady_clock::now();
+	MinePlacement::Plan const plan(w, h, m, s, safeZones);
+	mineNum = plan.getMineNum();
+	generationTimes.planMs = elapsedMs(begin);
+
+	begin = std::chrono::steady_clock::now();
+	int const tilesX = plan.getTilesX();
+	parallelFor(tilesX * plan.getTilesY(), threadNum, [&](int const t) { plan.placeTile(mined, t % tilesX, t / tilesX); });
+	generationTimes.placeMs = elapsedMs(begin);
+
+	// the counts of a row depend on the mines of the rows next to it only, and
+	// those are all laid by now: no reconciling along tile borders is needed
+	begin = std::chrono::steady_clock::now();
+	recountNeighborMines(threadNum);
+	generationTimes.countMs = elapsedMs(begin);
+}
+
+template<class Size> FieldTypes::CellState BasicField<Size>::getCell(int const x, int const y) const {
+	CellState c;
+	c.neighborMineNum = getNeighborMineNum(x, y);
+	c.status = getStatus(x, y);
+	c.isOpenedByFriend = openedByFriend.get(x, y);
+	c.isOpenedByEnemy = openedByEnemy.get(x, y);
+	c.isToOpenByFriend = toOpenByFriend.get(x, y);
+	c.isToOpenByEnemy = toOpenByEnemy.get(x, y);
+	return c;
+}
+
+template<class Size> bool BasicField<Size>::layMine(int const x, int const y) {
+	if(!isInside(x, y)) { return false; }
+	if(getStatus(x, y) != Status::free) { return false; }
+	openedByFriend.reset(x, y);
+	openedByEnemy.reset(x, y);
+	mined.set(x, y);
+	markDirty(x, y);
+
+	for(auto const& o : neighborOffsets) { neighborMineNums.add(x + o.dx, y + o.dy, 1); }
+	updateZeros(x, y);
+	return true;
+}
+
+template<class Size> void BasicField<Size>::recountNeighborMines(int const threadNum) {
+	// bands write rows of their own, but the pages they share with a snapshot
+	// must be copied before the threads start
+	neighborMineNums.makeWritable();
+	zeros.makeWritable();
+	parallelFor((getHeight() + rowBand - 1) / rowBand, threadNum, [&](int const band) {
+		recountRows(band * rowBand, std::min((band + 1) * rowBand, getHeight()));
+	});
+}
+
+template<class Size> void BasicField<Size>::recountRows(int const y0, int const y1) {
+	int const wordsPerRow = mined.getWordsPerRow();
+	std::vector<uint64_t> nonZero(wordsPerRow);
+	for(int y = y0; y < y1; y++) {
+		NeighborCount::countRow(mined.row(y - 1), mined.row(y), mined.row(y + 1), wordsPerRow, getWidth(), neighborMineNums.mutableRowBytes(y), nonZero.data());
+		for(int wi = 0; wi < wordsPerRow; wi++) {
+			uint64_t const isFree = ~(mined.row(y)[wi] | obstacle.row(y)[wi] | exploding.row(y)[wi]);
+			zeros.mutableRow(y)[wi] = isFree & ~nonZero[wi];
+		}
+	}
+}
+
+template<class Size> void BasicField<Size>::listRevealRings(int const x, int const y, int const rowBegin, int const rowEnd, std::vector<uint64_t> const& toList) {
+	// breadth first a word at a time, like the waves of explodeMine: a ring is the
+	// list of its nonzero words, grown by a cell into next (listing the words it
+	// reaches in touched) and masked to the free cells not reached yet
+	int const wordsPerRow = revealRegion.getWordsPerRow();
+	auto const index = [&](int const ry, int const wi) { return (size_t)(ry - rowBegin) * wordsPerRow + wi; };
+	std::vector<uint64_t> reached(toList.size()), next(toList.size());
+	std::vector<WaveWord> ring(1, WaveWord{y, x / 64, 1ULL << (x % 64)}), touched;
+	reached[index(y, x / 64)] = ring[0].bits;
+	for(int wave = 1; !ring.empty(); wave++) {
+		touched.clear();
+		for(auto const& r : ring) {
+			uint64_t const grown[3] = {r.bits << 63, r.bits | (r.bits << 1) | (r.bits >> 1), r.bits >> 63};
+			for(int ny = std::max(r.y - 1, rowBegin); ny <= std::min(r.y + 1, rowEnd); ny++) {
+				for(int k = 0; k < 3; k++) {
+					int const wi = r.wi - 1 + k;
+					if(wi < 0 || wi >= wordsPerRow || grown[k] == 0) { continue; }
+					uint64_t& n = next[index(ny, wi)];
+					if(n == 0) { touched.push_back(WaveWord{ny, wi, 0}); }
+					n |= grown[k];
+				}
+			}
+		}
+		ring.clear();
+		for(auto const& t : touched) {
+			size_t const i = index(t.y, t.wi);
+			uint64_t const isFree = ~(mined.row(t.y)[t.wi] | obstacle.row(t.y)[t.wi] | exploding.row(t.y)[t.wi]);
+			uint64_t const reachedNow = next[i] & isFree & ~reached[i];
+			next[i] = 0;
+			reached[i] |= reachedNow;
+			for(uint64_t w = reachedNow & toList[i]; w != 0; w &= w - 1) { dirtyCells.push_back(DirtyCell{t.wi * 64 + countTrailingZeros(w), t.y, wave}); }
+			// the reveal spreads on from the empty cells only
+			uint64_t const spreading = reachedNow & revealRegion.row(t.y)[t.wi];
+			if(spreading != 0) { ring.push_back(WaveWord{t.y, t.wi, spreading}); }
+		}
+	}
+}
+
+template<class Size> void BasicField<Size>::updateZeros(int const x, int const y) {
+	// the sentinels around the field are obstacles, so they stay out of the zero plane
+	zeros.assign(x, y, getStatus(x, y) == Status::free && getNeighborMineNum(x, y) == 0);
+	for(auto const& o : neighborOffsets) {
+		int const nx = x + o.dx, ny = y + o.dy;
+		zeros.assign(nx, ny, getStatus(nx, ny) == Status::free && getNeighborMineNum(nx, ny) == 0);
+	}
+}
+
+template<class Size> void BasicField<Size>::floodZeroRegion(int const x, int const y, int& top, int& bottom) {
+	// sweep down and up, seeding each row from the row before it (diagonals included)
+	// and growing the seeds along their runs of zeros, until a pair of sweeps adds nothing
+	int const wordsPerRow = revealRegion.getWordsPerRow();
+	auto const growRow = [&](int const ry, int const from) {
+		uint64_t* row = revealRegion.mutableRow(ry);
+		uint64_t const* mask = zeros.row(ry);
+		bool seeded = false;
+		for(int wi = 0; wi < wordsPerRow; wi++) {
+			uint64_t const seeds = BitBoard::widen(revealRegion.row(from), wi, wordsPerRow) & mask[wi] & ~row[wi];
+			if(seeds != 0) {
+				row[wi] |= seeds;
+				seeded = true;
+			}
+		}
+		if(seeded) { BitBoard::fillRuns(row, mask, wordsPerRow); }
+		return seeded;
+	};
+
+	revealRegion.set(x, y);
+	BitBoard::fillRuns(revealRegion.mutableRow(y), zeros.row(y), wordsPerRow);
+	top = bottom = y;
+	for(bool changed = true; changed;) {
+		changed = false;
+		for(int ry = top + 1; ry < getHeight(); ry++) {
+			if(growRow(ry, ry - 1)) {
+				changed = true;
+				bottom = std::max(bottom, ry);
+			} else if(ry > bottom) {
+				break;
+			}
+		}
+		for(int ry = bottom - 1; ry >= 0; ry--) {
+			if(growRow(ry, ry + 1)) {
+				changed = true;
+				top = std::min(top, ry);
+			} else if(ry < top) {
+				break;
+			}
+		}
+	}
+}
+
+template<class Size> void BasicField<Size>::explodeCell(int const x, int const y, int const wave) {
+	mined.reset(x, y);
+	exploding.set(x, y);
+	detonations.push_back(Detonation{y * getWidth() + x, tickCount + explosionTicks});
+	blasts.push_back(Blast{x, y, wave});
+	processedCells++;
+	markDirty(x, y, wave);
+}
+
+template<class Size> void BasicField<Size>::explodeMine(int const x, int const y) {
+	if(!isInside(x, y) || !mined.get(x, y)) { return; }
+
+	// a wave is the list of its nonzero words, so the work is in proportion to the
+	// mines blowing up and not to the rows they span
+	int const wordsPerRow = mined.getWordsPerRow();
+	std::vector<WaveWord> wave(1, WaveWord{y, x / 64, 1ULL << (x % 64)}), next, touched;
+	std::vector<uint64_t> nonZero(wordsPerRow);
+	for(int w = 0; !wave.empty(); w++) {
+		for(auto const& ww : wave) {
+			for(uint64_t bits = ww.bits; bits != 0; bits &= bits - 1) { explodeCell(ww.wi * 64 + countTrailingZeros(bits), ww.y, w); }
+		}
+
+		// recount the words of the wave and the words next to them, once each (listed
+		// by marking them in revealRegion), word-parallel like recountNeighborMines()
+		touched.clear();
+		for(auto const& ww : wave) {
+			int const wi0 = std::max(ww.wi - (int)(ww.bits & 1), 0), wi1 = std::min(ww.wi + (int)(ww.bits >> 63), wordsPerRow - 1);
+			for(int ny = std::max(ww.y - 1, 0); ny <= std::min(ww.y + 1, getHeight() - 1); ny++) {
+				for(int wi = wi0; wi <= wi1; wi++) {
+					uint64_t& mark = revealRegion.mutableRow(ny)[wi];
+					if(mark != 0) { continue; }
+					mark = 1;
+					touched.push_back(WaveWord{ny, wi, 0});
+				}
+			}
+		}
+		for(auto const& t : touched) {
+			NeighborCount::countWord(mined.row(t.y - 1), mined.row(t.y), mined.row(t.y + 1), t.wi, wordsPerRow, getWidth(),
+				neighborMineNums.mutableRowBytes(t.y), nonZero.data());
+			uint64_t const isFree = ~(mined.row(t.y)[t.wi] | obstacle.row(t.y)[t.wi] | exploding.row(t.y)[t.wi]);
+			zeros.mutableRow(t.y)[t.wi] = isFree & ~nonZero[t.wi];
+			revealRegion.mutableRow(t.y)[t.wi] = 0;
+		}
+		if(blastRadius == 0) { break; }
+
+		// the next wave: the mines left within blastRadius of the wave. Each word of the
+		// wave is grown east and west (into the words next to it), and or-ed into the
+		// rows blastRadius around it in revealRegion, listing the words it reaches.
+		std::vector<WaveWord> reached;
+		for(auto const& ww : wave) {
+			uint64_t grown[3] = {0, ww.bits, 0};
+			for(int s = 1; s <= blastRadius; s++) {
+				grown[0] |= ww.bits << (64 - s);
+				grown[1] |= (ww.bits << s) | (ww.bits >> s);
+				grown[2] |= ww.bits >> (64 - s);
+			}
+			for(int ny = std::max(ww.y - blastRadius, 0); ny <= std::min(ww.y + blastRadius, getHeight() - 1); ny++) {
+				uint64_t* row = revealRegion.mutableRow(ny);
+				for(int k = 0; k < 3; k++) {
+					int const wi = ww.wi - 1 + k;
+					if(wi < 0 || wi >= wordsPerRow || grown[k] == 0) { continue; }
+					if(row[wi] == 0) { reached.push_back(WaveWord{ny, wi, 0}); }
+					row[wi] |= grown[k];
+				}
+			}
+		}
+		next.clear();
+		for(auto const& r : reached) {
+			uint64_t& reach = revealRegion.mutableRow(r.y)[r.wi];
+			uint64_t const hit = reach & mined.row(r.y)[r.wi] & mined.validMask(r.wi);
+			reach = 0;
+			if(hit != 0) { next.push_back(WaveWord{r.y, r.wi, hit}); }
+		}
+		wave.swap(next);
+	}
+}
+
+template<class Size> void BasicField<Size>::endExplosion(int const x, int const y) {
+	if(!exploding.get(x, y)) { return; }
+	exploding.reset(x, y);
+	openedByFriend.set(x, y);
+	openedByEnemy.set(x, y);
+	markDirty(x, y);
+	updateZeros(x, y);
+}
+
+template<class Size> bool BasicField<Size>::openCell(int const x, int const y, bool const isFriend) {
+	if(!isInside(x, y)) { return false; }
+	auto const status = getStatus(x, y);
+	if(status == Status::mined) {
+		explodeMine(x, y);
+		return true;
+	}
+	if(status != Status::free) { return false; }
+
+	auto& opened = isFriend ? openedByFriend : openedByEnemy;
+	if(!opened.get(x, y)) {
+		opened.set(x, y);
+		if(isFriend) { markDirty(x, y); }
+	}
+	processedCells++;
+
+	// an empty cell opens its whole region and the numbered cells around it in one go:
+	// the region is flooded into revealRegion and grown by one cell a row at a time.
+	// The friends' view gets the cells it opens ring by ring.
+	if(!zeros.get(x, y)) { return false; }
+	int top, bottom;
+	floodZeroRegion(x, y, top, bottom);
+
+	int const wordsPerRow = revealRegion.getWordsPerRow();
+	int const rowBegin = std::max(top - 1, 0), rowEnd = std::min(bottom + 1, getHeight() - 1);
+	std::vector<uint64_t> toList(isFriend ? (size_t)(rowEnd - rowBegin + 1) * wordsPerRow : 0);
+	for(int ry = rowBegin; ry <= rowEnd; ry++) {
+		uint64_t* openedRow = opened.mutableRow(ry);
+		for(int wi = 0; wi < wordsPerRow; wi++) {
+			uint64_t grown = 0;
+			for(int dy = -1; dy < 2; dy++) {
+				if(ry + dy >= top && ry + dy <= bottom) { grown |= BitBoard::widen(revealRegion.row(ry + dy), wi, wordsPerRow); }
+			}
+			uint64_t const isFree = ~(mined.row(ry)[wi] | obstacle.row(ry)[wi] | exploding.row(ry)[wi]);
+			uint64_t const toOpen = grown & isFree & ~openedRow[wi];
+			if(toOpen == 0) { continue; }
+			openedRow[wi] |= toOpen;
+			processedCells += popCount(toOpen);
+			if(!isFriend) { continue; }
+			uint64_t* dirtyRow = dirty.mutableRow(ry);
+			toList[(size_t)(ry - rowBegin) * wordsPerRow + wi] = toOpen & ~dirtyRow[wi];
+			dirtyRow[wi] |= toOpen;
+		}
+	}
+	if(isFriend) { listRevealRings(x, y, rowBegin, rowEnd, toList); }
+	for(int ry = top; ry <= bottom; ry++) {
+		std::fill(revealRegion.mutableRow(ry), revealRegion.mutableRow(ry) + wordsPerRow, 0);
+	}
+
+	return false;
+}
+
+template<class Size> void BasicField<Size>::scheduleOpen(int const x, int const y, bool const isFriend) {
+	if(!isInside(x, y)) { return; }
+	if(!toOpenByFriend.get(x, y) && !toOpenByEnemy.get(x, y)) { scheduledCells.push_back(y * getWidth() + x); }
+	(isFriend ? toOpenByFriend : toOpenByEnemy).set(x, y);
+}
+
+template<class Size> void BasicField<Size>::tick() {
+	blasts.clear();
+
+	// cells scheduled while opening wait for the next tick
+	std::vector<int> cells;
+	cells.swap(scheduledCells);
+	for(auto const cell : cells) {
+		int const x = cell % getWidth(), y = cell / getWidth();
+		bool const byFriend = toOpenByFriend.get(x, y), byEnemy = toOpenByEnemy.get(x, y);
+		toOpenByFriend.reset(x, y);
+		toOpenByEnemy.reset(x, y);
+		processedCells++;
+		if(byFriend) { openCell(x, y, true); }
+		if(byEnemy) { openCell(x, y, false); }
+	}
+	if(scheduledCells.empty()) {
+		cells.clear();
+		scheduledCells.swap(cells);
+	}
+
+	// every explosion lasts as long, so they finish in the order they started
+	while(!detonations.empty() && detonations.front().endTick <= tickCount) {
+		int const cell = detonations.front().cell;
+		detonations.pop_front();
+		processedCells++;
+		endExplosion(cell % getWidth(), cell / getWidth());
+	}
+
+	tickCount++;
+	lastProcessedCells = processedCells;
+	processedCells = 0;
+}
+
+template<class Size> void BasicField<Size>::setOuterMine(int const x, int const y, bool const isMined) {
+	if(isInside(x, y) || mined.get(x, y) == isMined) { return; }
+	mined.assign(x, y, isMined);
+	// the ring's own neighbors may lie beyond the padding, so check them here
+	for(auto const& o : neighborOffsets) {
+		int const nx = x + o.dx, ny = y + o.dy;
+		if(!isInside(nx, ny)) { continue; }
+		neighborMineNums.add(nx, ny, isMined ? 1 : -1);
+		zeros.assign(nx, ny, getStatus(nx, ny) == Status::free && getNeighborMineNum(nx, ny) == 0);
+		markDirty(nx, ny);
+	}
+}
+
+template<class Size> void BasicField<Size>::saveCompact(std::vector<uint8_t>& out) const {
+	appendRuns(out, mined);
+	appendRuns(out, openedByFriend);
+	appendRuns(out, openedByEnemy);
+}
+
+template<class Size> bool BasicField<Size>::loadCompact(std::vector<uint8_t> const& data) {
+	BitPlane m(getWidth(), getHeight()), f(getWidth(), getHeight()), e(getWidth(), getHeight());
+	uint8_t const* p = data.data();
+	uint8_t const* end = p + data.size();
+	if(!readRuns(p, end, m) || !readRuns(p, end, f) || !readRuns(p, end, e) || p != end) { return false; }
+
+	mineNum = 0;
+	for(int y = 0; y < getHeight(); y++) for(int x = 0; x < getWidth(); x++) {
+		mined.assign(x, y, m.get(x, y));
+		mineNum += m.get(x, y);
+		openedByFriend.assign(x, y, f.get(x, y));
+		openedByEnemy.assign(x, y, e.get(x, y));
+	}
+	recountNeighborMines();
+	return true;
+}
+
+template<class Size> uint64_t BasicField<Size>::hashState() const {
+	uint64_t h = hashMix(hashMix(0xCBF29CE484222325ULL, (uint64_t)tickCount), (uint64_t)blastRadius);
+	for(int y = 0; y < getHeight(); y++) for(int x = 0; x < getWidth(); x++) {
+		auto const c = getCell(x, y);
+		h = hashMix(h, ((int)c.status << 8) | (c.neighborMineNum << 4) | (c.isOpenedByFriend << 3) | (c.isOpenedByEnemy << 2)
+			| (c.isToOpenByFriend << 1) | (int)c.isToOpenByEnemy);
+	}
+	for(auto const cell : scheduledCells) { h = hashMix(h, (uint64_t)cell); }
+	for(auto const& d : detonations) { h = hashMix(hashMix(h, (uint64_t)d.cell), (uint64_t)d.endTick); }
+	return h;
+}
+
+template<class Size> bool BasicField<Size>::save(char const* path) const {
+	FileHeader header;
+	std::memcpy(header.magic, fileMagic, sizeof(header.magic));
+	header.version = fileVersion;
+	header.byteOrder = fileByteOrder;
+	header.width = getWidth();
+	header.height = getHeight();
+	header.mineNum = mineNum;
+	header.blastRadius = blastRadius;
+	header.seed = seed;
+	header.tickCount = tickCount;
+	header.scheduledNum = (uint32_t)scheduledCells.size();
+	header.detonationNum = (uint32_t)detonations.size();
+
+	std::vector<uint8_t> head(sizeof(FileHeader));
+	auto const append = [&](void const* p, size_t const n) { head.insert(head.end(), (uint8_t const*)p, (uint8_t const*)p + n); };
+	for(auto const cell : scheduledCells) {
+		uint32_t const c = (uint32_t)cell;
+		append(&c, sizeof(c));
+	}
+	for(auto const& d : detonations) {
+		int64_t const pair[2] = {d.cell, d.endTick};
+		append(pair, sizeof(pair));
+	}
+	header.planesOffset = (head.size() + 63) & ~(size_t)63;
+	head.resize((size_t)header.planesOffset, 0);
+	std::memcpy(head.data(), &header, sizeof(header));
+
+	std::FILE* const file = std::fopen(path, "wb");
+	if(!file) { return false; }
+	size_t const rowWords = BitPlane::rowWordsFor(getWidth()) * 8;
+	BitPlane const* const bitPlanes[savedBitPlaneNum] = {
+		&mined, &obstacle, &exploding, &openedByFriend, &openedByEnemy, &toOpenByFriend, &toOpenByEnemy, &zeros
+	};
+	bool ok = std::fwrite(head.data(), 1, head.size(), file) == head.size();
+	for(int i = 0; i < savedBitPlaneNum && ok; i++) { ok = writePlane(file, *bitPlanes[i], rowWords); }
+	ok = ok && writePlane(file, neighborMineNums, (size_t)NibblePlane::rowBytesFor(getWidth()));
+	return std::fclose(file) == 0 && ok;
+}
+
+template<class Size> bool BasicField<Size>::hasSoundPlanes() const {
+	int const wordsPerRow = obstacle.getWordsPerRow();
+	int const countBytes = NibblePlane::rowBytesFor(getWidth()) - 4;
+	// the bit of the ring cell right of the row, in word wi
+	auto const ringBit = [&](int const wi) { return wi == getWidth() / 64 ? 1ULL << (getWidth() % 64) : 0; };
+	BitPlane const* const innerPlanes[] = {&exploding, &openedByFriend, &openedByEnemy, &toOpenByFriend, &toOpenByEnemy, &zeros};
+	for(int y = -1; y <= getHeight(); y++) {
+		bool const isPadding = y < 0 || y == getHeight();
+		if(obstacle.row(y)[-1] != ~0ULL || (mined.row(y)[-1] & ~(1ULL << 63)) != 0) { return false; }
+		for(auto const plane : innerPlanes) { if(plane->row(y)[-1] != 0) { return false; } }
+		for(int wi = 0; wi < wordsPerRow; wi++) {
+			uint64_t const inside = isPadding ? 0 : obstacle.validMask(wi);
+			uint64_t const m = mined.row(y)[wi], o = obstacle.row(y)[wi], e = exploding.row(y)[wi];
+			if((o | inside) != ~0ULL || (m & ~(inside | ringBit(wi) | (isPadding ? obstacle.validMask(wi) : 0))) != 0) { return false; }
+			for(auto const plane : innerPlanes) { if((plane->row(y)[wi] & ~inside) != 0) { return false; } }
+			if((((m & o) | (m & e) | (o & e)) & inside) != 0) { return false; }
+			if(isPadding) { continue; }
+
+			// the counts of the word's cells, two a byte
+			uint8_t const* counts = neighborMineNums.rowBytes(y) + wi * 32;
+			uint64_t noMines = 0, overEight = 0;
+			for(int i = 0; i < std::min(32, countBytes - wi * 32); i++) {
+				int const low = counts[i] & 0xF, high = counts[i] >> 4;
+				noMines |= (uint64_t)((low == 0) | (high == 0) << 1) << (2 * i);
+				overEight |= (uint64_t)((low > 8) | (high > 8) << 1) << (2 * i);
+			}
+			if((overEight & inside) != 0 || (zeros.row(y)[wi] & inside) != (~(m | o | e) & noMines & inside)) { return false; }
+		}
+	}
+	return true;
+}
+
+template<class Size> bool BasicField<Size>::load(char const* path) {
+	auto const file = std::make_shared<MappedFile>();
+	if(!file->open(path) || file->getSize() < sizeof(FileHeader)) { return false; }
+	FileHeader header;
+	std::memcpy(&header, file->getData(), sizeof(header));
+	if(std::memcmp(header.magic, fileMagic, sizeof(header.magic)) != 0 || header.version != fileVersion || header.byteOrder != fileByteOrder) { return false; }
+	int const w = header.width, h = header.height;
+	if(w <= 0 || h <= 0 || (long long)w * h > 0x7FFFFFFF) { return false; }
+	if(Size::fixedWidth != 0 && (w != (int)Size::fixedWidth || h != (int)Size::fixedHeight)) { return false; }
+
+	uint64_t const cellNum = (uint64_t)w * h;
+	// what setBlastRadius allows: the blast is grown by shifts within a 64-bit word
+	if(header.blastRadius < 0 || header.blastRadius > 63 || header.mineNum < 0 || (uint64_t)header.mineNum > cellNum) { return false; }
+	uint64_t const listBytes = (uint64_t)header.scheduledNum * 4 + (uint64_t)header.detonationNum * 16;
+	uint64_t const planeBytes = savedBitPlaneNum * (uint64_t)savedBitPlaneBytes(w, h) + savedNibblePlaneBytes(w, h);
+	if(header.scheduledNum > cellNum || header.detonationNum > cellNum || header.planesOffset % 64 != 0
+		|| header.planesOffset < sizeof(FileHeader) + listBytes || header.planesOffset + planeBytes > file->getSize()) { return false; }
+
+	BasicField loaded(w, h, file->getData() + header.planesOffset, file);
+	loaded.mineNum = header.mineNum;
+	loaded.blastRadius = header.blastRadius;
+	loaded.seed = header.seed;
+	loaded.tickCount = header.tickCount;
+	if(!loaded.hasSoundPlanes()) { return false; }
+	uint8_t const* p = file->getData() + sizeof(FileHeader);
+	for(uint32_t i = 0; i < header.scheduledNum; i++, p += 4) {
+		uint32_t c;
+		std::memcpy(&c, p, sizeof(c));
+		if(c >= cellNum) { return false; }
+		loaded.scheduledCells.push_back((int)c);
+	}
+	for(uint32_t i = 0; i < header.detonationNum; i++, p += 16) {
+		int64_t pair[2];
+		std::memcpy(pair, p, sizeof(pair));
+		if(pair[0] < 0 || (uint64_t)pair[0] >= cellNum) { return false; }
+		loaded.detonations.push_back(Detonation{(int)pair[0], pair[1]});
+	}
+	*this = std::move(loaded);
+	return true;
+}
+
+template<class Size> void BasicField<Size>::clearDirtyCells() {
+	for(auto const& c : dirtyCells) { dirty.reset(c.x, c.y); }
+	dirtyCells.clear();
+}
+
+template<class Size> FieldTypes::Visual BasicField<Size>::getVisual(int const x, int const y) const {
+	switch(getStatus(x, y)) {
+	case Status::mined:
+		return Visual::mined;
+	case Status::obstacle:
+		return Visual::obstacle;
+	case Status::exploding:
+		return Visual::exploding;
+	default:
+		if(!openedByFriend.get(x, y)) { return Visual::closed; }
+		return (Visual)((int)Visual::open0 + getNeighborMineNum(x, y));
+	}
+}
+
+template<class Size> void BasicField<Size>::takeVisualChanges(std::vector<VisualChange>& out) {
+	for(auto const& c : dirtyCells) { out.push_back(VisualChange{c.x, c.y, getVisual(c.x, c.y), c.wave}); }
+	clearDirtyCells();
+}
+
+// the sizes in use: any size, the classic boards and the chunks of ChunkedWorld
+template class BasicField<RuntimeSize>;
+template class BasicField<FixedSize<9, 9>>;
+template class BasicField<FixedSize<16, 16>>;
+template class BasicField<FixedSize<30, 16>>;
+template class BasicField<FixedSize<64, 64>>;
@@ -0,0 +1,292 @@
+#pragma once
+#include "BitBoard.h"
+#include "MinePlacement.h"
+#include <deque>
+#include <memory>
+
+// Engine-free field rules. Nothing in here may depend on ace.h so that the
+// simulation can be built and run headless (see CMakeLists.txt).
+
+/// the types every BasicField shares, whatever its size.
+struct FieldTypes {
+	enum class Status {
+		free,
+		mined, // mined, obstacle and exploding are synchronized over the whole map
+		obstacle,
+		exploding // mined -> exploding -> damage -> free
+	};
+
+	/// a copy of one cell's state, assembled from the planes.
+	struct CellState {
+		int neighborMineNum = 0;
+		Status status = Status::free;
+		bool isOpenedByFriend = false;
+		bool isOpenedByEnemy = false;
+
+		// scheduled for the next tick
+		bool isToOpenByFriend = false;
+		bool isToOpenByEnemy = false;
+	};
+
+	/// a cell whose look changed. wave is the ring of a friend reveal it was opened in
+	/// (its breadth-first distance from the opened cell through the empty region),
+	/// or the wave of a chain reaction it blew up in (0 for every other change), so
+	/// a view can replay a reveal or a chain one wave per frame.
+	struct DirtyCell {
+		int x, y, wave;
+	};
+
+	/// what a cell looks like to the friendly side: its status, or, once the friends
+	/// opened a free cell, its count (open0 + count).
+	enum class Visual : uint8_t {
+		closed, mined, obstacle, exploding,
+		open0, open1, open2, open3, open4, open5, open6, open7, open8
+	};
+	static const int visualNum = 13;
+
+	/// an entry of the render-diff queue (see BasicField::takeVisualChanges): a cell,
+	/// its look now and the wave it changed in (see DirtyCell).
+	struct VisualChange {
+		int x, y;
+		Visual visual;
+		int wave;
+	};
+
+	/// a mine that blew up. wave is its step in the chain reaction: 0 for the mine
+	/// set off, n + 1 for the mines caught by the blasts of wave n.
+	struct Blast {
+		int x, y, wave;
+	};
+
+	/// ticks an explosion lasts before the cell turns free
+	static const int explosionTicks = 30;
+
+	/// wall-clock time each phase of building the field took, in milliseconds
+	struct GenerationTimes {
+		double planMs = 0, placeMs = 0, countMs = 0;
+	};
+};
+
+/// Storage is 10 bit planes plus 4 bits of neighbor count, i.e. 14 bits per cell:
+/// about 1.7 MB per million cells (plus a padding ring around each plane, see
+/// BitPlane). A 2000x2000 field takes 7 MB.
+///
+/// Size is RuntimeSize (Field: any size, planes on the heap in copy-on-write pages,
+/// so a copy is O(1)) or FixedSize<W, H> (FixedField<W, H>: the size is a constant
+/// everywhere and the planes are inline, so building one allocates next to nothing).
+/// Both have the same interface.
+/// The sizes the game uses are instantiated in Field.cpp; add any other there.
+///
+/// Work is driven by worklists (scheduled opens, running explosions, cells whose
+/// look changed), so a tick with nothing going on costs the same on any map size.
+template<class Size> class BasicField : public FieldTypes, private Size {
+	typedef BasicBitPlane<Size> BitPlane;
+	typedef BasicNibblePlane<Size> NibblePlane;
+
+	// structure of arrays: status is split over three exclusive bit planes
+	// (a cell with none of them set is free), and the counts are packed 4 bits per cell.
+	// The padding ring of the planes holds obstacles, so neighbor loops need no bounds checks.
+	BitPlane mined, obstacle, exploding;
+	NibblePlane neighborMineNums;
+	BitPlane openedByFriend, openedByEnemy;
+	BitPlane toOpenByFriend, toOpenByEnemy;
+	BitPlane dirty;
+	int mineNum;
+	uint64_t seed;
+
+	struct Detonation {
+		int cell;
+		long long endTick;
+	};
+
+	// worklists. The planes above double as membership tests, so a cell is listed once.
+	std::vector<int> scheduledCells;
+	std::deque<Detonation> detonations;
+	std::vector<DirtyCell> dirtyCells;
+
+	// free cells without a neighboring mine, the index of the zero regions: built with
+	// the counts and kept by layMine and explodeMine a 3x3 block at a time, never
+	// rebuilt. Opening one of them floods its region through this plane with bit
+	// operations, into revealRegion; a labeled index (one union-find label per cell)
+	// would need 8 bytes a cell and a relabel whenever a mine splits a region, and
+	// walking its cells missed the cache. A chain reaction gathers the reach of its
+	// blasts in revealRegion too; both leave it clear.
+	BitPlane zeros;
+	BitPlane revealRegion;
+
+	long long tickCount = 0;
+	long long processedCells = 0, lastProcessedCells = 0;
+	GenerationTimes generationTimes;
+
+	// a blast sets off the mines up to blastRadius cells away (0: none)
+	int blastRadius = 1;
+	std::vector<Blast> blasts;
+
+	bool isInside(int const x, int const y) const { return x >= 0 && x < getWidth() && y >= 0 && y < getHeight(); }
+
+	void markDirty(int const x, int const y, int const wave = 0) {
+		if(dirty.get(x, y)) { return; }
+		dirty.set(x, y);
+		dirtyCells.push_back(DirtyCell{x, y, wave});
+	}
+
+	/// refresh the zero bits of the 3x3 block around (x, y).
+	void updateZeros(int const x, int const y);
+
+	/// flood the zero region around the zero cell (x, y) into revealRegion.
+	/// top and bottom receive the rows it spans.
+	void floodZeroRegion(int const x, int const y, int& top, int& bottom);
+	/// list the cells of toList as dirty, each with its ring: its breadth-first
+	/// distance from (x, y) through the region flooded into revealRegion, the tick it
+	/// used to be opened in when a reveal spread a ring per tick. toList holds the
+	/// words of rows rowBegin .. rowEnd.
+	void listRevealRings(int const x, int const y, int const rowBegin, int const rowEnd, std::vector<uint64_t> const& toList);
+
+	void explodeCell(int const x, int const y, int const wave);
+
+	/// recountNeighborMines() for rows y0 .. y1 - 1 only.
+	void recountRows(int const y0, int const y1);
+
+	/// whether the planes hold a field the game can run on: a wall of obstacles around
+	/// it, nothing else outside it but the outer mines (see setOuterMine), one status
+	/// per cell, counts up to 8 and zero bits that agree with them. load() checks a
+	/// file with this, as the planes are used as they are.
+	bool hasSoundPlanes() const;
+
+	/// a field on planes as save() writes them, used in place. owner keeps them alive.
+	BasicField(int const w, int const h, uint8_t* planes, std::shared_ptr<void> const& owner);
+
+public:
+	/// build a width x height field and lay mineNum mines, none inside safeZones.
+	/// There may be fewer mines if the field has no room for them. The same seed and
+	/// arguments always give the same field, on every platform (see MinePlacement::Plan),
+	/// whatever the number of threads that build it.
+	/// A FixedField takes width and height too; they must be its own.
+	BasicField(int const width, int const height, int const mineNum, uint64_t const seed, std::vector<CellRect> const& safeZones = std::vector<CellRect>(),
+		int const threadNum = 1);
+	/// the same with a random seed; getSeed() tells which.
+	BasicField(int const width, int const height, int const mineNum, std::vector<CellRect> const& safeZones = std::vector<CellRect>());
+
+	using Size::getWidth;
+	using Size::getHeight;
+	int getMineNum() const { return mineNum; }
+	uint64_t getSeed() const { return seed; }
+	GenerationTimes const& getGenerationTimes() const { return generationTimes; }
+
+	CellState getCell(int const x, int const y) const;
+	Status getStatus(int const x, int const y) const {
+		if(mined.get(x, y)) { return Status::mined; }
+		if(exploding.get(x, y)) { return Status::exploding; }
+		if(obstacle.get(x, y)) { return Status::obstacle; }
+		return Status::free;
+	}
+	int getNeighborMineNum(int const x, int const y) const { return neighborMineNums.get(x, y); }
+	Visual getVisual(int const x, int const y) const;
+	bool isOpenedByFriend(int const x, int const y) const { return openedByFriend.get(x, y); }
+	bool isOpenedByEnemy(int const x, int const y) const { return openedByEnemy.get(x, y); }
+
+	/// lay a mine
+	/// @return true iff succeeded to mine.
+	bool layMine(int const x, int const y);
+
+	/// recompute every neighbor count and the zero plane from the mines in one pass,
+	/// 64 to 256 cells at a time (see NeighborCount.h), split into bands of rows over
+	/// threadNum threads. Much faster than laying the mines one by one when most of
+	/// the field changes.
+	void recountNeighborMines(int const threadNum = 1);
+
+	/// detonate the mine on the cell. It turns free explosionTicks ticks later.
+	/// The blast sets off the mines within the blast radius, theirs the next ones and
+	/// so on, all within this call: the chain is processed breadth first, one wave
+	/// of mines at a time, and the counts are updated once per wave.
+	void explodeMine(int const x, int const y);
+
+	int getBlastRadius() const { return blastRadius; }
+	/// mines up to radius cells away (in any direction, diagonals included) are set
+	/// off by a blast. 0 means a mine only blows itself up; at most 63.
+	void setBlastRadius(int const radius) { blastRadius = std::min(std::max(radius, 0), 63); }
+
+	/// the mines that blew up in the last tick() and since, e.g. to damage what is
+	/// within the blast radius of one.
+	std::vector<Blast> const& getBlasts() const { return blasts; }
+
+	/// turn an exploding cell into an opened free cell
+	void endExplosion(int const x, int const y);
+
+	/// open the cell. An empty cell opens its whole connected empty region and the
+	/// numbered cells around it right away.
+	/// @return true iff the cell is mined
+	bool openCell(int const x, int const y, bool const isFriend);
+
+	/// open the cell on the next tick.
+	void scheduleOpen(int const x, int const y, bool const isFriend);
+
+	/// open the scheduled cells and finish the explosions that are due.
+	void tick();
+
+	/// true iff nothing is scheduled and no explosion is running.
+	bool isIdle() const { return scheduledCells.empty() && detonations.empty(); }
+
+	/// lay or lift a mine on the padding ring (x = -1 or width, or y = -1 or height),
+	/// so that the counts along that edge see it. A field that is part of a larger
+	/// map takes the mines of the cells around it this way.
+	void setOuterMine(int const x, int const y, bool const isMined);
+
+	/// append the mines and the opened cells in a compact run-length form.
+	/// The field must be idle.
+	void saveCompact(std::vector<uint8_t>& out) const;
+	/// restore what saveCompact wrote for a field of the same size and recount.
+	/// Mines on the padding ring are kept.
+	/// @return false if the data is not a field of this size; nothing is changed then
+	bool loadCompact(std::vector<uint8_t> const& data);
+
+	/// a hash of everything that decides how the field plays on: the cells, the tick
+	/// count, the blast radius and the pending opens and explosions. Equal fields hash
+	/// alike on every platform.
+	uint64_t hashState() const;
+
+	/// a copy of the field to go back to with restore(), or to play on, e.g. to look
+	/// ahead. A Field shares its planes page by page with its copies until one of them
+	/// writes to a page (see Storage), so a snapshot costs O(1) plus the pending
+	/// opens and explosions. A FixedField is copied whole.
+	BasicField snapshot() const { return *this; }
+	/// go back to a snapshot of this field; as cheap as taking it.
+	void restore(BasicField const& s) { *this = s; }
+
+	/// write the whole state of the field to a file: size, seed, every plane and the
+	/// pending opens and explosions (see the format in Field.cpp). The planes are
+	/// written as they are in memory, in a few large writes.
+	/// @return false if the file could not be written
+	bool save(char const* path) const;
+	/// replace this field with one save() wrote. A Field maps the file and uses the
+	/// planes in place, with no parsing: the pages it writes are copied in memory,
+	/// and the file never changes. A FixedField copies them (and takes its own size only).
+	/// They are read through once to check them (see hasSoundPlanes).
+	/// Cells changed since the save are not listed as dirty.
+	/// @return false if the file cannot be read or is not a sound field; nothing is changed then
+	bool load(char const* path);
+
+	/// cells whose look changed since the last clearDirtyCells(), in the order they changed.
+	std::vector<DirtyCell> const& getDirtyCells() const { return dirtyCells; }
+	void clearDirtyCells();
+	/// the render-diff queue: append every dirty cell once, with its look as it is
+	/// now, in the order they changed, and clear the dirty cells. However many times
+	/// a cell changed since the last call, it is listed once; it may look the same as
+	/// it did then.
+	void takeVisualChanges(std::vector<VisualChange>& out);
+
+	/// number of cells opened, scheduled or exploded between the last two ticks,
+	/// including the work done by tick() itself.
+	long long getProcessedCellCount() const { return lastProcessedCells; }
+};
+
+/// a field of any size
+using Field = BasicField<RuntimeSize>;
+/// a field of a size fixed at compile time
+template<int W, int H> using FixedField = BasicField<FixedSize<W, H>>;
+
+extern template class BasicField<RuntimeSize>;
+extern template class BasicField<FixedSize<9, 9>>;
+extern template class BasicField<FixedSize<16, 16>>;
+extern template class BasicField<FixedSize<30, 16>>;
+extern template class BasicField<FixedSize<64, 64>>;
@@ -0,0 +1,37 @@
+#include "GameSession.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+GameSession::GameSession(uint64_t const seed, int const minesPerChunk, int const maxResidentChunks) :
+	world(seed, minesPerChunk, maxResidentChunks,
+		std::vector<CellRect>(1, CellRect{-safeSpawnRadius, -safeSpawnRadius, safeSpawnRadius * 2 + 1, safeSpawnRadius * 2 + 1})) {}
+
+void GameSession::step(int const keys) {
+	world.tick();
+
+	// every blast that reaches the tank's cell hits it
+	hits.clear();
+	int const tankX = (int)std::floor(tank.getX() / cellPitch), tankY = (int)std::floor(tank.getY() / cellPitch);
+	for(auto const& b : world.getBlasts()) {
+		if(std::max(std::abs(b.x - tankX), std::abs(b.y - tankY)) > world.getBlastRadius()) { continue; }
+		hits.push_back(b);
+		hitCount++;
+	}
+
+	// chunks are loaded a screen ahead of the camera, which is centered on the tank
+	int const cameraX = (int)(tank.getX() + 0.5f) - viewWidth / 2, cameraY = (int)(tank.getY() + 0.5f) - viewHeight / 2;
+	int const shownX = cameraX - viewWidth / 2, shownY = cameraY - viewHeight / 2;
+	world.showArea(CellRect{(int)std::floor(shownX / cellPitch), (int)std::floor(shownY / cellPitch),
+		(int)(viewWidth * 2 / cellPitch) + 2, (int)(viewHeight * 2 / cellPitch) + 2});
+
+	tank.move(keys);
+	frameCount++;
+}
+
+uint64_t GameSession::hashState() const {
+	uint64_t h = world.hashState();
+	h = (h ^ tank.hashState()) * 0x100000001B3ULL;
+	h = (h ^ (uint64_t)hitCount) * 0x100000001B3ULL;
+	return (h ^ (uint64_t)frameCount) * 0x100000001B3ULL;
+}
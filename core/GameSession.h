@@ -0,0 +1,42 @@
+#pragma once
+#include "ChunkedWorld.h"
+#include "Tank.h"
+
+/// the size of a cell on screen, in pixels
+static const float cellPitch = 246.0f / 4.0f;
+
+/// the game without its view: the world and the tank, stepped a frame at a time by
+/// the keys held. Everything in it follows from the seed and the keys, so a game can
+/// be recorded and played again headless, as fast as it goes (see Replay.h).
+class GameSession {
+public:
+	/// the screen, in pixels; the chunks around it are kept resident.
+	static const int viewWidth = 800, viewHeight = 600;
+	/// the tank starts at the origin, on cell (0, 0), with no mines this near.
+	static const int safeSpawnRadius = 2;
+
+private:
+	ChunkedWorld world;
+	Tank tank;
+	std::vector<FieldTypes::Blast> hits;
+	int hitCount = 0;
+	long long frameCount = 0;
+
+public:
+	GameSession(uint64_t const seed, int const minesPerChunk, int const maxResidentChunks);
+
+	/// one frame: tick the world, see which blasts reach the tank, load the chunks a
+	/// screen around the camera and move the tank by the keys held (Tank::Key bits).
+	void step(int const keys);
+
+	ChunkedWorld& getWorld() { return world; }
+	Tank const& getTank() const { return tank; }
+
+	/// the blasts that hit the tank in the last step().
+	std::vector<FieldTypes::Blast> const& getHits() const { return hits; }
+	int getHitCount() const { return hitCount; }
+	long long getFrameCount() const { return frameCount; }
+
+	/// a hash of the world, the tank and the hits; a replay ends on the hash the game did.
+	uint64_t hashState() const;
+};
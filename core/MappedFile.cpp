@@ -0,0 +1,70 @@
+#include "MappedFile.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+bool MappedFile::open(char const* path) {
+	close();
+	file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE) {
+		file = nullptr;
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		close();
+		return false;
+	}
+	mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if(!mapping) {
+		close();
+		return false;
+	}
+	data = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+	if(!data) {
+		close();
+		return false;
+	}
+	size = (size_t)fileSize.QuadPart;
+	return true;
+}
+
+void MappedFile::close() {
+	if(data) { UnmapViewOfFile(data); }
+	if(mapping) { CloseHandle(mapping); }
+	if(file) { CloseHandle(file); }
+	data = nullptr;
+	size = 0;
+	mapping = file = nullptr;
+}
+#else
+bool MappedFile::open(char const* path) {
+	close();
+	int const fd = ::open(path, O_RDONLY);
+	if(fd < 0) { return false; }
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+	// the mapping holds the file open by itself
+	void* const p = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if(p == MAP_FAILED) { return false; }
+	data = (uint8_t*)p;
+	size = (size_t)st.st_size;
+	return true;
+}
+
+void MappedFile::close() {
+	if(data) { munmap(data, size); }
+	data = nullptr;
+	size = 0;
+}
+#endif
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/// a whole file mapped into memory, copy on write: the mapping can be written to,
+/// but the writes stay in memory and never reach the file.
+class MappedFile {
+	uint8_t* data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	void* file = nullptr;
+	void* mapping = nullptr;
+#endif
+
+	MappedFile(MappedFile const&);
+	MappedFile& operator=(MappedFile const&);
+
+public:
+	MappedFile() {}
+	~MappedFile() { close(); }
+
+	/// map the file, unmapping the one mapped before.
+	/// @return false if it cannot be opened or mapped, or is empty
+	bool open(char const* path);
+	void close();
+
+	uint8_t* getData() const { return data; }
+	size_t getSize() const { return size; }
+};
@@ -0,0 +1,90 @@
+#include "MinePlacement.h"
+#include "CounterRng.h"
+
+namespace MinePlacement {
+	namespace {
+		/// the excluded cells of the tile, as sorted indices y * tileSize + x into it.
+		std::vector<int> excludedInTile(std::vector<CellRect> const& exclusions, CellRect const& tile) {
+			std::vector<int> cells;
+			for(auto const& r : exclusions) {
+				for(int y = std::max(r.y, tile.y); y < std::min(r.y + r.height, tile.y + tile.height); y++) {
+					for(int x = std::max(r.x, tile.x); x < std::min(r.x + r.width, tile.x + tile.width); x++) {
+						cells.push_back((y - tile.y) * tileSize + x - tile.x);
+					}
+				}
+			}
+			std::sort(cells.begin(), cells.end());
+			cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+			return cells;
+		}
+
+		// stream 0 is for the plan; tile t draws from stream t + 1
+		const uint64_t planStream = 0;
+	}
+
+	Plan::Plan(int const w, int const h, int const m, uint64_t const s, std::vector<CellRect> const& e) :
+		width(w), height(h), tilesX((w + tileSize - 1) / tileSize), tilesY((h + tileSize - 1) / tileSize), mineNum(0),
+		seed(s), exclusions(e), tileMineNums(tilesX * tilesY, 0), tileCellNums(tilesX * tilesY, 0) {
+
+		long long cellNum = 0;
+		for(int ty = 0; ty < tilesY; ty++) for(int tx = 0; tx < tilesX; tx++) {
+			CellRect const tile{tx * tileSize, ty * tileSize, std::min(tileSize, width - tx * tileSize), std::min(tileSize, height - ty * tileSize)};
+			int const n = tile.width * tile.height - (int)excludedInTile(exclusions, tile).size();
+			tileCellNums[ty * tilesX + tx] = n;
+			cellNum += n;
+		}
+		mineNum = (int)std::max(std::min((long long)m, cellNum), 0LL);
+		if(mineNum == 0) { return; }
+
+		// every tile gets the whole part of its share; the odd mines go one each to
+		// tiles with a fractional part left, chosen by Floyd's sampling
+		std::vector<int> roundedDown;
+		int odd = mineNum;
+		for(int t = 0; t < tilesX * tilesY; t++) {
+			long long const share = (long long)mineNum * tileCellNums[t];
+			tileMineNums[t] = (int)(share / cellNum);
+			odd -= tileMineNums[t];
+			if(share % cellNum != 0) { roundedDown.push_back(t); }
+		}
+		CounterRng rng(seed, planStream);
+		int const candidates = (int)roundedDown.size();
+		std::vector<bool> chosen(candidates, false);
+		for(int j = candidates - odd; j < candidates; j++) {
+			int c = (int)rng.below((uint64_t)j + 1);
+			if(chosen[c]) { c = j; }
+			chosen[c] = true;
+			tileMineNums[roundedDown[c]]++;
+		}
+	}
+
+	void Plan::tileMines(int const tx, int const ty, uint64_t (&rows)[tileSize]) const {
+		std::fill(rows, rows + tileSize, 0);
+		int const num = getTileMineNum(tx, ty);
+		if(num == 0) { return; }
+		CellRect const tile{tx * tileSize, ty * tileSize, std::min(tileSize, width - tx * tileSize), std::min(tileSize, height - ty * tileSize)};
+
+		// cell c (y * tileSize + x) of the tile is cell number c - (excluded cells
+		// before c) of those left. Cells past the tile's width count as excluded.
+		std::vector<int> excluded = excludedInTile(exclusions, tile);
+		if(tile.width < tileSize) {
+			for(int y = 0; y < tile.height; y++) for(int x = tile.width; x < tileSize; x++) { excluded.push_back(y * tileSize + x); }
+			std::sort(excluded.begin(), excluded.end());
+		}
+		// gaps[i]: number of cells left before excluded[i]; never decreases
+		std::vector<int> gaps(excluded.size());
+		for(size_t i = 0; i < excluded.size(); i++) { gaps[i] = excluded[i] - (int)i; }
+		auto const nthCell = [&](int const n) {
+			return n + (int)(std::upper_bound(gaps.begin(), gaps.end(), n) - gaps.begin());
+		};
+
+		// Floyd: for j = cellNum - num .. cellNum - 1 take a random t <= j, or j itself
+		// if t was taken already (j cannot have been)
+		int const cellNum = tileCellNums[ty * tilesX + tx];
+		CounterRng rng(seed, (uint64_t)(ty * tilesX + tx) + 1);
+		for(int j = cellNum - num; j < cellNum; j++) {
+			int c = nthCell((int)rng.below((uint64_t)j + 1));
+			if((rows[c / tileSize] >> (c % tileSize)) & 1) { c = nthCell(j); }
+			rows[c / tileSize] |= 1ULL << (c % tileSize);
+		}
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "Planes.h"
+
+/// a rectangle of cells
+struct CellRect {
+	int x, y, width, height;
+};
+
+namespace MinePlacement {
+	/// tiles are 64x64 cells, so a tile covers one word of each of its rows
+	static const int tileSize = 64;
+
+	/// where the mines of a field go, tile by tile. Every tile gets its share of the
+	/// mines (in proportion to its cells outside the exclusions, the odd mines going to
+	/// tiles chosen at random), and lays them by Floyd's sampling over its cells left:
+	/// O(mines) draws at any density.
+	///
+	/// The draws come from CounterRng streams keyed by (seed, tile), so a tile can be
+	/// laid alone, on any thread and in any order, with the same result as the whole map.
+	class Plan {
+		int width, height, tilesX, tilesY, mineNum;
+		uint64_t seed;
+		std::vector<CellRect> exclusions;
+		// per tile: mines and cells left outside the exclusions
+		std::vector<int> tileMineNums, tileCellNums;
+
+	public:
+		/// plan mineNum mines, none inside the exclusions (e.g. a safe area around a
+		/// spawn point). There are fewer if the field has no room for them.
+		Plan(int const width, int const height, int const mineNum, uint64_t const seed, std::vector<CellRect> const& exclusions);
+
+		int getTilesX() const { return tilesX; }
+		int getTilesY() const { return tilesY; }
+		/// the mines all tiles together lay
+		int getMineNum() const { return mineNum; }
+		int getTileMineNum(int const tx, int const ty) const { return tileMineNums[ty * tilesX + tx]; }
+
+		/// the mines of one tile as one word per row: bit x of rows[y] is cell
+		/// (tx * tileSize + x, ty * tileSize + y). Rows past the field stay 0.
+		void tileMines(int const tx, int const ty, uint64_t (&rows)[tileSize]) const;
+
+		/// lay the mines of one tile on an empty tile of the mine plane (a BitPlane
+		/// of any size). Only the tile's own words are written.
+		template<class Plane> void placeTile(Plane& mines, int const tx, int const ty) const {
+			uint64_t rows[tileSize];
+			tileMines(tx, ty, rows);
+			for(int y = 0; y < tileSize && ty * tileSize + y < height; y++) { mines.mutableRow(ty * tileSize + y)[tx] |= rows[y]; }
+		}
+
+		/// lay every tile.
+		template<class Plane> void place(Plane& mines) const {
+			for(int ty = 0; ty < tilesY; ty++) for(int tx = 0; tx < tilesX; tx++) { placeTile(mines, tx, ty); }
+		}
+	};
+}
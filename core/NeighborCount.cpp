@@ -0,0 +1,183 @@
+#include "NeighborCount.h"
+#include "BitBoard.h"
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define NEIGHBOR_COUNT_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace NeighborCount {
+	// set by NeighborCountAvx2.cpp when it was compiled for AVX2
+	extern bool const isAvx2Built;
+
+	void countWord(uint64_t const* up, uint64_t const* mid, uint64_t const* down, int const wi, int const wordsPerRow, int const width,
+		uint8_t* nibbles, uint64_t* nonZero) {
+		auto const c = BitBoard::countNeighbors(up, mid, down, wi, wordsPerRow);
+		nonZero[wi] = c.bit0 | c.bit1 | c.bit2 | c.bit3;
+		for(int g = 0; g < 8 && wi * 64 + g * 8 < width; g++) {
+			uint32_t const v = BitBoard::groupNibbles(c, g);
+			uint8_t* p = nibbles + wi * 32 + g * 4;
+			for(int i = 0; i < 4; i++) { p[i] = (uint8_t)(v >> (i * 8)); }
+		}
+	}
+
+	void countRowScalar(uint64_t const* up, uint64_t const* mid, uint64_t const* down, int const wordsPerRow, int const width,
+		uint8_t* nibbles, uint64_t* nonZero) {
+		for(int wi = 0; wi < wordsPerRow; wi++) { countWord(up, mid, down, wi, wordsPerRow, width, nibbles, nonZero); }
+	}
+
+#ifdef NEIGHBOR_COUNT_SSE2
+	namespace {
+		inline __m128i load(uint64_t const* p) { return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p)); }
+
+		// words wi and wi + 1 moved by one cell; words wi - 1 and wi + 2 must exist.
+		inline __m128i fromWest(uint64_t const* row, int const wi) {
+			return _mm_or_si128(_mm_slli_epi64(load(row + wi), 1), _mm_srli_epi64(load(row + wi - 1), 63));
+		}
+		inline __m128i fromEast(uint64_t const* row, int const wi) {
+			return _mm_or_si128(_mm_srli_epi64(load(row + wi), 1), _mm_slli_epi64(load(row + wi + 1), 63));
+		}
+
+		inline void halfAdd(__m128i const a, __m128i const b, __m128i& sum, __m128i& carry) {
+			sum = _mm_xor_si128(a, b);
+			carry = _mm_and_si128(a, b);
+		}
+		inline void fullAdd(__m128i const a, __m128i const b, __m128i const c, __m128i& sum, __m128i& carry) {
+			__m128i const u = _mm_xor_si128(a, b);
+			sum = _mm_xor_si128(u, c);
+			carry = _mm_or_si128(_mm_and_si128(a, b), _mm_and_si128(u, c));
+		}
+
+		/// 0xFF for every set bit of bits, one byte per bit.
+		inline __m128i bitsToBytes(uint32_t const bits) {
+			__m128i x = _mm_cvtsi32_si128((int)bits);
+			x = _mm_unpacklo_epi8(x, x);
+			x = _mm_unpacklo_epi16(x, x);
+			x = _mm_unpacklo_epi32(x, x);
+			__m128i const mask = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+			return _mm_cmpeq_epi8(_mm_and_si128(x, mask), mask);
+		}
+
+		/// one count per byte for the 16 cells from bit shift of the four count planes.
+		inline __m128i countBytes(uint64_t const* bits, int const shift) {
+			__m128i r = _mm_and_si128(bitsToBytes((uint32_t)(bits[0] >> shift) & 0xFFFF), _mm_set1_epi8(1));
+			r = _mm_or_si128(r, _mm_and_si128(bitsToBytes((uint32_t)(bits[1] >> shift) & 0xFFFF), _mm_set1_epi8(2)));
+			r = _mm_or_si128(r, _mm_and_si128(bitsToBytes((uint32_t)(bits[2] >> shift) & 0xFFFF), _mm_set1_epi8(4)));
+			return _mm_or_si128(r, _mm_and_si128(bitsToBytes((uint32_t)(bits[3] >> shift) & 0xFFFF), _mm_set1_epi8(8)));
+		}
+
+		/// pack pairs of count bytes into nibbles: 16 counts into the low 8 bytes.
+		inline __m128i packNibbles(__m128i const counts) {
+			__m128i const low = _mm_and_si128(counts, _mm_set1_epi16(0x00FF));
+			return _mm_or_si128(low, _mm_slli_epi16(_mm_srli_epi16(counts, 8), 4));
+		}
+	}
+
+	void countRowSse2(uint64_t const* up, uint64_t const* mid, uint64_t const* down, int const wordsPerRow, int const width,
+		uint8_t* nibbles, uint64_t* nonZero) {
+		// two words per step. The first word and the words that reach past the end of
+		// the row (or whose nibbles do not fill 32 bytes) take the scalar path.
+		int const stride = (width + 7) & ~7;
+		countWord(up, mid, down, 0, wordsPerRow, width, nibbles, nonZero);
+		int wi = 1;
+		for(; wi + 2 < wordsPerRow && (wi + 2) * 64 <= stride; wi += 2) {
+			__m128i s0, c0, s1, c1, s2, c2, c3, t, d, e, bit0, bit1, bit2, bit3;
+			fullAdd(fromWest(up, wi), load(up + wi), fromEast(up, wi), s0, c0);
+			fullAdd(fromWest(down, wi), load(down + wi), fromEast(down, wi), s1, c1);
+			halfAdd(fromWest(mid, wi), fromEast(mid, wi), s2, c2);
+			fullAdd(s0, s1, s2, bit0, c3);
+			fullAdd(c0, c1, c2, t, d);
+			halfAdd(t, c3, bit1, e);
+			halfAdd(d, e, bit2, bit3);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(nonZero + wi), _mm_or_si128(_mm_or_si128(bit0, bit1), _mm_or_si128(bit2, bit3)));
+
+			uint64_t bits[2][4];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&bits[0][0]), _mm_unpacklo_epi64(bit0, bit1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&bits[0][2]), _mm_unpacklo_epi64(bit2, bit3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&bits[1][0]), _mm_unpackhi_epi64(bit0, bit1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&bits[1][2]), _mm_unpackhi_epi64(bit2, bit3));
+			for(int k = 0; k < 2; k++) {
+				auto* p = reinterpret_cast<__m128i*>(nibbles + (wi + k) * 32);
+				for(int h = 0; h < 2; h++) {
+					__m128i const a = packNibbles(countBytes(bits[k], h * 32)), b = packNibbles(countBytes(bits[k], h * 32 + 16));
+					_mm_storeu_si128(p + h, _mm_packus_epi16(a, b));
+				}
+			}
+		}
+		for(; wi < wordsPerRow; wi++) { countWord(up, mid, down, wi, wordsPerRow, width, nibbles, nonZero); }
+	}
+#else
+	void countRowSse2(uint64_t const* up, uint64_t const* mid, uint64_t const* down, int const wordsPerRow, int const width,
+		uint8_t* nibbles, uint64_t* nonZero) {
+		countRowScalar(up, mid, down, wordsPerRow, width, nibbles, nonZero);
+	}
+#endif
+
+	namespace {
+		bool cpuHasAvx2() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+			int info[4];
+			__cpuid(info, 0);
+			if(info[0] < 7) { return false; }
+			__cpuid(info, 1);
+			bool const osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+			__cpuidex(info, 7, 0);
+			return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+			return __builtin_cpu_supports("avx2") != 0;
+#else
+			return false;
+#endif
+		}
+
+		using RowKernel = void (*)(uint64_t const*, uint64_t const*, uint64_t const*, int, int, uint8_t*, uint64_t*);
+
+		Isa widestSupported() {
+			if(isSupported(Isa::avx2)) { return Isa::avx2; }
+			if(isSupported(Isa::sse2)) { return Isa::sse2; }
+			return Isa::scalar;
+		}
+
+		Isa selected = widestSupported();
+	}
+
+	bool isSupported(Isa const isa) {
+		switch(isa) {
+		case Isa::avx2:
+			return isAvx2Built && cpuHasAvx2();
+		case Isa::sse2:
+#ifdef NEIGHBOR_COUNT_SSE2
+			return true;
+#else
+			return false;
+#endif
+		default:
+			return true;
+		}
+	}
+
+	char const* getName(Isa const isa) {
+		switch(isa) {
+		case Isa::avx2: return "avx2";
+		case Isa::sse2: return "sse2";
+		default: return "scalar";
+		}
+	}
+
+	Isa getSelected() { return selected; }
+
+	bool select(Isa const isa) {
+		if(!isSupported(isa)) { return false; }
+		selected = isa;
+		return true;
+	}
+
+	void countRow(uint64_t const* up, uint64_t const* mid, uint64_t const* down, int const wordsPerRow, int const width,
+		uint8_t* nibbles, uint64_t* nonZero) {
+		static RowKernel const kernels[] = {countRowScalar, countRowSse2, countRowAvx2};
+		kernels[(int)selected](up, mid, down, wordsPerRow, width, nibbles, nonZero);
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+
+// Bulk neighbor counting for a whole row of cells. The counts are summed with the
+// bit-sliced adder of BitBoard.h, 64 cells per word, and the wider kernels run it
+// on 2 (SSE2) or 4 (AVX2) words at once. The kernel is picked at runtime from what
+// the CPU supports.
+
+namespace NeighborCount {
+	enum class Isa {
+		scalar,
+		sse2,
+		avx2
+	};
+
+	bool isSupported(Isa const isa);
+	char const* getName(Isa const isa);
+
+	/// the kernel countRow uses. Defaults to the widest supported one.
+	Isa getSelected();
+	/// force a kernel, e.g. to compare them.
+	/// @return true iff the CPU supports it
+	bool select(Isa const isa);
+
+	/// count the mines around every cell of the middle row.
+	/// up, mid and down are mine rows of wordsPerRow words (the padding rows of the
+	/// BitPlane at the edges of the field). The counts are stored as nibbles for the
+	/// width cells of the row, and nonZero receives a bit per cell with a count above 0.
+	void countRow(uint64_t const* up, uint64_t const* mid, uint64_t const* down, int const wordsPerRow, int const width,
+		uint8_t* nibbles, uint64_t* nonZero);
+
+	// the kernels themselves
+	void countRowScalar(uint64_t const* up, uint64_t const* mid, uint64_t const* down, int const wordsPerRow, int const width,
+		uint8_t* nibbles, uint64_t* nonZero);
+	void countRowSse2(uint64_t const* up, uint64_t const* mid, uint64_t const* down, int const wordsPerRow, int const width,
+		uint8_t* nibbles, uint64_t* nonZero);
+	void countRowAvx2(uint64_t const* up, uint64_t const* mid, uint64_t const* down, int const wordsPerRow, int const width,
+		uint8_t* nibbles, uint64_t* nonZero);
+
+	/// count one word with the scalar kernel; the wide kernels use it for the words
+	/// at the ends of a row.
+	void countWord(uint64_t const* up, uint64_t const* mid, uint64_t const* down, int const wi, int const wordsPerRow, int const width,
+		uint8_t* nibbles, uint64_t* nonZero);
+}
@@ -0,0 +1,95 @@
+// Built with AVX2 code generation enabled (see CMakeLists.txt and MinePanzer.vcxproj);
+// nothing in here runs unless NeighborCount::isSupported(Isa::avx2).
+#include "NeighborCount.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace NeighborCount {
+#ifdef __AVX2__
+	extern bool const isAvx2Built = true;
+
+	namespace {
+		inline __m256i load(uint64_t const* p) { return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)); }
+
+		// words wi .. wi + 3 moved by one cell; words wi - 1 and wi + 4 must exist.
+		inline __m256i fromWest(uint64_t const* row, int const wi) {
+			return _mm256_or_si256(_mm256_slli_epi64(load(row + wi), 1), _mm256_srli_epi64(load(row + wi - 1), 63));
+		}
+		inline __m256i fromEast(uint64_t const* row, int const wi) {
+			return _mm256_or_si256(_mm256_srli_epi64(load(row + wi), 1), _mm256_slli_epi64(load(row + wi + 1), 63));
+		}
+
+		inline void halfAdd(__m256i const a, __m256i const b, __m256i& sum, __m256i& carry) {
+			sum = _mm256_xor_si256(a, b);
+			carry = _mm256_and_si256(a, b);
+		}
+		inline void fullAdd(__m256i const a, __m256i const b, __m256i const c, __m256i& sum, __m256i& carry) {
+			__m256i const u = _mm256_xor_si256(a, b);
+			sum = _mm256_xor_si256(u, c);
+			carry = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+		}
+
+		/// weight for every set bit of bits, one byte per bit.
+		inline __m256i bitsToBytes(uint32_t const bits, __m256i const weight) {
+			__m256i const spread = _mm256_setr_epi8(
+				0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+				2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+			__m256i const mask = _mm256_setr_epi8(
+				1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+				1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+			__m256i const x = _mm256_shuffle_epi8(_mm256_set1_epi32((int)bits), spread);
+			return _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(x, mask), mask), weight);
+		}
+
+		/// the 32 counts from bit shift of the four count planes as nibble pairs in
+		/// 16-bit lanes (still interleaved per 128-bit lane by packing).
+		inline __m256i countPairs(uint64_t const* bits, int const shift) {
+			__m256i r = bitsToBytes((uint32_t)(bits[0] >> shift), _mm256_set1_epi8(1));
+			r = _mm256_or_si256(r, bitsToBytes((uint32_t)(bits[1] >> shift), _mm256_set1_epi8(2)));
+			r = _mm256_or_si256(r, bitsToBytes((uint32_t)(bits[2] >> shift), _mm256_set1_epi8(4)));
+			r = _mm256_or_si256(r, bitsToBytes((uint32_t)(bits[3] >> shift), _mm256_set1_epi8(8)));
+			// even cell + 16 * odd cell
+			return _mm256_maddubs_epi16(r, _mm256_set1_epi16(0x1001));
+		}
+	}
+
+	void countRowAvx2(uint64_t const* up, uint64_t const* mid, uint64_t const* down, int const wordsPerRow, int const width,
+		uint8_t* nibbles, uint64_t* nonZero) {
+		// four words per step, the ends of the row as in countRowSse2
+		int const stride = (width + 7) & ~7;
+		countWord(up, mid, down, 0, wordsPerRow, width, nibbles, nonZero);
+		int wi = 1;
+		for(; wi + 4 < wordsPerRow && (wi + 4) * 64 <= stride; wi += 4) {
+			__m256i s0, c0, s1, c1, s2, c2, c3, t, d, e, bit0, bit1, bit2, bit3;
+			fullAdd(fromWest(up, wi), load(up + wi), fromEast(up, wi), s0, c0);
+			fullAdd(fromWest(down, wi), load(down + wi), fromEast(down, wi), s1, c1);
+			halfAdd(fromWest(mid, wi), fromEast(mid, wi), s2, c2);
+			fullAdd(s0, s1, s2, bit0, c3);
+			fullAdd(c0, c1, c2, t, d);
+			halfAdd(t, c3, bit1, e);
+			halfAdd(d, e, bit2, bit3);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(nonZero + wi), _mm256_or_si256(_mm256_or_si256(bit0, bit1), _mm256_or_si256(bit2, bit3)));
+
+			uint64_t planes[4][4];
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(planes[0]), bit0);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(planes[1]), bit1);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(planes[2]), bit2);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(planes[3]), bit3);
+			for(int k = 0; k < 4; k++) {
+				uint64_t const bits[4] = {planes[0][k], planes[1][k], planes[2][k], planes[3][k]};
+				__m256i const packed = _mm256_packus_epi16(countPairs(bits, 0), countPairs(bits, 32));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(nibbles + (wi + k) * 32), _mm256_permute4x64_epi64(packed, 0xD8));
+			}
+		}
+		for(; wi < wordsPerRow; wi++) { countWord(up, mid, down, wi, wordsPerRow, width, nibbles, nonZero); }
+	}
+#else
+	extern bool const isAvx2Built = false;
+
+	void countRowAvx2(uint64_t const* up, uint64_t const* mid, uint64_t const* down, int const wordsPerRow, int const width,
+		uint8_t* nibbles, uint64_t* nonZero) {
+		countRowScalar(up, mid, down, wordsPerRow, width, nibbles, nonZero);
+	}
+#endif
+}
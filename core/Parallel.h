@@ -0,0 +1,20 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/// run fn(i) for i = 0 .. count - 1 on up to threadNum threads, the calling one
+/// included. Items are handed out one at a time as threads get free, so which
+/// thread runs an item varies from run to run: fn(i) must give the same result on
+/// any thread and must not touch what other items write.
+template<class F> void parallelFor(int const count, int const threadNum, F const& fn) {
+	std::atomic<int> next(0);
+	auto const work = [&]() {
+		for(int i = next++; i < count; i = next++) { fn(i); }
+	};
+	std::vector<std::thread> threads;
+	for(int t = 1; t < std::min(threadNum, count); t++) { threads.emplace_back(work); }
+	work();
+	for(auto& t : threads) { t.join(); }
+}
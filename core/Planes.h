@@ -0,0 +1,269 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/// index of the lowest set bit. w must not be 0.
+inline int countTrailingZeros(uint64_t const w) {
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long i;
+	_BitScanForward64(&i, w);
+	return (int)i;
+#elif defined(_MSC_VER)
+	unsigned long i;
+	if(_BitScanForward(&i, (unsigned long)w)) { return (int)i; }
+	_BitScanForward(&i, (unsigned long)(w >> 32));
+	return (int)i + 32;
+#else
+	return __builtin_ctzll(w);
+#endif
+}
+
+/// number of set bits.
+inline int popCount(uint64_t w) {
+#if defined(_MSC_VER)
+	w = w - ((w >> 1) & 0x5555555555555555ULL);
+	w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+	w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (int)((w * 0x0101010101010101ULL) >> 56);
+#else
+	return __builtin_popcountll(w);
+#endif
+}
+
+/// the size of a plane or a field, given at runtime.
+class RuntimeSize {
+	int width = 0, height = 0;
+
+public:
+	/// the size known at compile time; 0 for none.
+	enum { fixedWidth = 0, fixedHeight = 0 };
+
+	RuntimeSize() {}
+	RuntimeSize(int const w, int const h) : width(w), height(h) {}
+
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+};
+
+/// a size fixed at compile time. Row strides, word counts and indices derived from
+/// it fold into constants, and planes of this size hold their cells inline.
+template<int W, int H> class FixedSize {
+public:
+	enum { fixedWidth = W, fixedHeight = H };
+
+	FixedSize() {}
+	/// w and h must be W and H; taken so that both kinds of size are built alike.
+	FixedSize(int const w, int const h) {
+		assert(w == W && h == H);
+		(void)w;
+		(void)h;
+	}
+
+	int getWidth() const { return W; }
+	int getHeight() const { return H; }
+};
+
+/// rowNum rows of rowItems zero-initialized items. They are inline when their
+/// number N is known at compile time; copying the storage copies them.
+template<class T, size_t N> class Storage {
+	std::array<T, N> items;
+
+public:
+	Storage(int const, int const) : items() {}
+	/// rows stored back to back (see the other Storage); copied here.
+	Storage(int const, int const, T const* from, std::shared_ptr<void> const&) : items() { std::copy(from, from + N, items.begin()); }
+
+	T const* row(int const r, int const rowItems) const { return items.data() + (size_t)r * rowItems; }
+	T* mutableRow(int const r, int const rowItems) { return items.data() + (size_t)r * rowItems; }
+
+	/// make every row writable now rather than on first write, e.g. before rows
+	/// are written from several threads.
+	void makeWritable() {}
+
+	/// call f(rows, n) for runs of n rows stored back to back, in order.
+	template<class F> void forEachRun(int const rowNum, int const, F const& f) const { f(items.data(), rowNum); }
+};
+
+/// rows per page of the storage below: 2^pageRowShift
+static const int pageRowShift = 4;
+
+/// the storage of a size known at runtime (N = 0): pages of 2^pageRowShift rows on
+/// the heap, shared between copies of the storage until one of them writes to a
+/// page (copy on write). So a copy takes O(1), and two copies that differ in a few
+/// rows share the rest.
+///
+/// A pointer from mutableRow() stays valid until the storage is copied or assigned;
+/// one from row() may be left behind on the old page by a later write to the row.
+template<class T> class Storage<T, 0> {
+	typedef std::vector<std::shared_ptr<T>> PageTable;
+	std::shared_ptr<PageTable> pages;
+	size_t pageItems;
+
+	std::shared_ptr<T> newPage(T const* from) const {
+		std::shared_ptr<T> page(new T[pageItems](), std::default_delete<T[]>());
+		if(from) { std::copy(from, from + pageItems, page.get()); }
+		return page;
+	}
+
+	/// the page, copied first if it is shared
+	T* writablePage(size_t const pi) {
+		if(pages.use_count() != 1) { pages = std::make_shared<PageTable>(*pages); }
+		auto& page = (*pages)[pi];
+		if(page.use_count() != 1) { page = newPage(page.get()); }
+		return page.get();
+	}
+
+public:
+	Storage(int const rowNum, int const rowItems) : pages(std::make_shared<PageTable>()), pageItems((size_t)rowItems << pageRowShift) {
+		for(int r = 0; r < rowNum; r += 1 << pageRowShift) { pages->push_back(newPage(nullptr)); }
+	}
+	/// use rowNum rows stored back to back and padded to whole pages, e.g. in a
+	/// mapped file, in place: every page points into them, and is written in place
+	/// too. owner keeps them alive as long as a page does.
+	Storage(int const rowNum, int const rowItems, T* from, std::shared_ptr<void> const& owner) :
+		pages(std::make_shared<PageTable>()), pageItems((size_t)rowItems << pageRowShift) {
+		for(int r = 0; r < rowNum; r += 1 << pageRowShift) { pages->push_back(std::shared_ptr<T>(from + (r >> pageRowShift) * pageItems, [owner](T*) {})); }
+	}
+
+	T const* row(int const r, int const rowItems) const {
+		return (*pages)[r >> pageRowShift].get() + (size_t)(r & ((1 << pageRowShift) - 1)) * rowItems;
+	}
+	T* mutableRow(int const r, int const rowItems) {
+		return writablePage(r >> pageRowShift) + (size_t)(r & ((1 << pageRowShift) - 1)) * rowItems;
+	}
+
+	void makeWritable() {
+		for(size_t pi = 0; pi < pages->size(); pi++) { writablePage(pi); }
+	}
+
+	/// call f(rows, n) for runs of n rows stored back to back, in order.
+	template<class F> void forEachRun(int const rowNum, int const, F const& f) const {
+		for(int r = 0; r < rowNum; r += 1 << pageRowShift) { f((*pages)[r >> pageRowShift].get(), std::min(rowNum - r, 1 << pageRowShift)); }
+	}
+};
+
+/// one bit per cell. Every row starts on a fresh 64-bit word so that rows can be
+/// scanned and combined word by word.
+///
+/// The field is surrounded by a padding ring: one row above and one below, at
+/// least one bit after the end of every row, and a guard word in front of every
+/// row whose top bit is the cell left of it. So row(-1) and row(height) exist, and
+/// the cells of a 3x3 block around any field cell can be accessed without bounds
+/// checks. Rows with their guard word do not overlap, so they can be stored apart
+/// (see Storage).
+template<class Size> class BasicBitPlane : private Size {
+	static const size_t fixedWordNum = Size::fixedWidth == 0 ? 0 : ((size_t)Size::fixedWidth / 64 + 2) * (Size::fixedHeight + 2);
+	Storage<uint64_t, fixedWordNum> words;
+
+	// the word of cell x in its row, and the bit in it; x may be -1
+	static int wordOf(int const x) { return ((x + 64) >> 6) - 1; }
+	static int bitOf(int const x) { return (x + 64) & 63; }
+
+public:
+	/// words per row of a plane w cells wide, the guard word included
+	static int rowWordsFor(int const w) { return w / 64 + 2; }
+
+	BasicBitPlane(int const w, int const h) : Size(w, h), words(h + 2, rowWordsFor(w)) {}
+	/// a plane of rows -1 .. height with their guard words, stored back to back
+	/// (see Storage).
+	BasicBitPlane(int const w, int const h, uint64_t* rows, std::shared_ptr<void> const& owner) : Size(w, h), words(h + 2, rowWordsFor(w), rows, owner) {}
+
+	using Size::getWidth;
+	using Size::getHeight;
+	int getWordsPerRow() const { return getWidth() / 64 + 1; }
+	int getRowWords() const { return rowWordsFor(getWidth()); }
+
+	/// y may be -1 or height for the padding rows. row[-1] is the guard word.
+	uint64_t const* row(int const y) const { return words.row(y + 1, getRowWords()) + 1; }
+	uint64_t* mutableRow(int const y) { return words.mutableRow(y + 1, getRowWords()) + 1; }
+
+	/// the bits of word wi that lie inside the row
+	uint64_t validMask(int const wi) const {
+		int const begin = wi * 64;
+		if(begin + 64 <= getWidth()) { return ~0ULL; }
+		return begin >= getWidth() ? 0 : (1ULL << (getWidth() - begin)) - 1;
+	}
+
+	// x may range from -1 to width, y from -1 to height.
+	bool get(int const x, int const y) const { return (row(y)[wordOf(x)] >> bitOf(x)) & 1; }
+	void set(int const x, int const y) { mutableRow(y)[wordOf(x)] |= 1ULL << bitOf(x); }
+	void reset(int const x, int const y) { mutableRow(y)[wordOf(x)] &= ~(1ULL << bitOf(x)); }
+	void assign(int const x, int const y, bool const v) { if(v) { set(x, y); } else { reset(x, y); } }
+
+	/// make every row writable now (see Storage::makeWritable).
+	void makeWritable() { words.makeWritable(); }
+	/// call f(rows, n) for runs of n rows, guard words included, from row -1 on.
+	template<class F> void forEachRun(F const& f) const { words.forEachRun(getHeight() + 2, getRowWords(), f); }
+
+	/// set every bit of the padding ring, e.g. to make it a wall of sentinel cells.
+	void setPadding() {
+		for(int y = -1; y <= getHeight(); y++) {
+			uint64_t* r = mutableRow(y);
+			r[-1] = ~0ULL;
+			for(int wi = 0; wi < getWordsPerRow(); wi++) { r[wi] |= y < 0 || y == getHeight() ? ~0ULL : ~validMask(wi); }
+		}
+	}
+};
+
+/// 4 bits per cell, two cells per byte. Rows are padded to a multiple of 8 cells so
+/// that a row can be written 8 cells (32 bits) at a time. Like BitPlane there is a
+/// padding ring around the field, and 8 guard cells in front of every row: the
+/// padding cells take whatever is written to them.
+template<class Size> class BasicNibblePlane : private Size {
+	static const size_t fixedByteNum = Size::fixedWidth == 0 ? 0 : (4 + ((size_t)Size::fixedWidth + 8) / 8 * 4) * (Size::fixedHeight + 2);
+	Storage<uint8_t, fixedByteNum> bytes;
+
+public:
+	/// bytes per row of a plane w cells wide: 8 guard cells, then at least one cell
+	/// more than the width
+	static int rowBytesFor(int const w) { return 4 + ((w + 8) & ~7) / 2; }
+
+	BasicNibblePlane(int const w, int const h) : Size(w, h), bytes(h + 2, rowBytesFor(w)) {}
+	/// a plane of rows -1 .. height with their guard cells, stored back to back
+	/// (see Storage).
+	BasicNibblePlane(int const w, int const h, uint8_t* rows, std::shared_ptr<void> const& owner) : Size(w, h), bytes(h + 2, rowBytesFor(w), rows, owner) {}
+
+	using Size::getWidth;
+	using Size::getHeight;
+	int getRowBytes() const { return rowBytesFor(getWidth()); }
+
+	// x may range from -1 to width, y from -1 to height.
+	int get(int const x, int const y) const {
+		int const i = 8 + x;
+		return (bytes.row(y + 1, getRowBytes())[i >> 1] >> ((i & 1) * 4)) & 0xF;
+	}
+	void set(int const x, int const y, int const v) {
+		int const i = 8 + x;
+		int const shift = (i & 1) * 4;
+		uint8_t& b = bytes.mutableRow(y + 1, getRowBytes())[i >> 1];
+		b = (uint8_t)((b & ~(0xF << shift)) | ((v & 0xF) << shift));
+	}
+	/// add d to the cell, modulo 16.
+	void add(int const x, int const y, int const d) { set(x, y, get(x, y) + d); }
+
+	/// row y, cell 2i in the low and cell 2i + 1 in the high nibble of byte i.
+	uint8_t const* rowBytes(int const y) const { return bytes.row(y + 1, getRowBytes()) + 4; }
+	uint8_t* mutableRowBytes(int const y) { return bytes.mutableRow(y + 1, getRowBytes()) + 4; }
+	/// make every row writable now (see Storage::makeWritable).
+	void makeWritable() { bytes.makeWritable(); }
+	/// call f(rows, n) for runs of n rows, guard cells included, from row -1 on.
+	template<class F> void forEachRun(F const& f) const { bytes.forEachRun(getHeight() + 2, getRowBytes(), f); }
+	void clear() {
+		for(int y = -1; y <= getHeight(); y++) {
+			uint8_t* r = bytes.mutableRow(y + 1, getRowBytes());
+			std::fill(r, r + getRowBytes(), 0);
+		}
+	}
+};
+
+/// planes sized at runtime
+using BitPlane = BasicBitPlane<RuntimeSize>;
+using NibblePlane = BasicNibblePlane<RuntimeSize>;
@@ -0,0 +1,357 @@
+#include "Png.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+	/// reads a DEFLATE stream's bits, least significant first. Past the end it reads
+	/// zeros, and remembers how many so that running over can be told.
+	class BitReader {
+		uint8_t const* p;
+		uint8_t const* end;
+		uint64_t bits = 0;
+		int bitNum = 0, zeroBitNum = 0;
+
+		void refill() {
+			while(bitNum <= 56) {
+				if(p < end) {
+					bits |= (uint64_t)*p++ << bitNum;
+				} else {
+					zeroBitNum += 8;
+				}
+				bitNum += 8;
+			}
+		}
+
+	public:
+		BitReader(uint8_t const* data, size_t const size) : p(data), end(data + size) {}
+
+		uint32_t peek(int const n) {
+			if(bitNum < n) { refill(); }
+			return (uint32_t)(bits & ((1ULL << n) - 1));
+		}
+		void consume(int const n) {
+			bits >>= n;
+			bitNum -= n;
+		}
+		uint32_t read(int const n) {
+			uint32_t const v = peek(n);
+			consume(n);
+			return v;
+		}
+		/// true if more bits were used than the stream has
+		bool hasOverrun() const { return bitNum < zeroBitNum; }
+
+		/// skip to the next byte boundary, for stored blocks and the checksum.
+		void alignToByte() { consume(bitNum & 7); }
+		/// the first byte not read yet, after alignToByte().
+		uint8_t const* bytePosition() const { return p - (bitNum - zeroBitNum) / 8; }
+		void seek(uint8_t const* to) {
+			p = to;
+			bits = 0;
+			bitNum = 0;
+			zeroBitNum = 0;
+		}
+		uint8_t const* getEnd() const { return end; }
+	};
+
+	/// a canonical Huffman code as one lookup table over its longest code length:
+	/// entry = symbol << 4 | code length, indexed by the next bits of the stream.
+	class Huffman {
+		std::vector<uint16_t> table;
+		int maxLength = 0;
+
+	public:
+		/// @return false if the lengths do not make a code
+		bool build(uint8_t const* lengths, int const symbolNum) {
+			int counts[16] = {0};
+			for(int s = 0; s < symbolNum; s++) { counts[lengths[s]]++; }
+			counts[0] = 0;
+			maxLength = 0;
+			for(int l = 1; l < 16; l++) {
+				if(counts[l] > 0) { maxLength = l; }
+			}
+			if(maxLength == 0) {
+				// no symbols: any use of the code is an error
+				table.assign(1, 0);
+				return true;
+			}
+			int left = 1;
+			for(int l = 1; l < 16; l++) {
+				left = left * 2 - counts[l];
+				if(left < 0) { return false; }
+			}
+			int nextCode[16] = {0};
+			for(int l = 1, code = 0; l < 16; l++) {
+				code = (code + counts[l - 1]) << 1;
+				nextCode[l] = code;
+			}
+			table.assign((size_t)1 << maxLength, 0);
+			for(int s = 0; s < symbolNum; s++) {
+				int const l = lengths[s];
+				if(l == 0) { continue; }
+				int const code = nextCode[l]++;
+				int reversed = 0;
+				for(int i = 0; i < l; i++) { reversed |= ((code >> i) & 1) << (l - 1 - i); }
+				for(int i = reversed; i < (1 << maxLength); i += 1 << l) { table[i] = (uint16_t)(s << 4 | l); }
+			}
+			return true;
+		}
+
+		/// @return the next symbol, or -1 if the bits are not a code
+		int decode(BitReader& in) const {
+			uint16_t const e = table[in.peek(maxLength)];
+			if((e & 15) == 0) { return -1; }
+			in.consume(e & 15);
+			return e >> 4;
+		}
+	};
+
+	const int lengthBases[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+	const int lengthExtras[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+	const int distanceBases[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+	const int distanceExtras[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+	/// the symbols of one compressed block, up to its end-of-block code; false if the
+	/// output would grow past outEnd.
+	bool inflateBlock(BitReader& in, Huffman const& litLength, Huffman const& distance, std::vector<uint8_t>& out, size_t const outBegin, size_t const outEnd) {
+		for(;;) {
+			int const symbol = litLength.decode(in);
+			if(symbol < 0 || in.hasOverrun()) { return false; }
+			if(symbol < 256) {
+				if(out.size() >= outEnd) { return false; }
+				out.push_back((uint8_t)symbol);
+				continue;
+			}
+			if(symbol == 256) { return true; }
+			if(symbol > 285) { return false; }
+			int const length = lengthBases[symbol - 257] + (int)in.read(lengthExtras[symbol - 257]);
+			int const d = distance.decode(in);
+			if(d < 0 || d > 29) { return false; }
+			size_t const back = (size_t)distanceBases[d] + in.read(distanceExtras[d]);
+			if(back > out.size() - outBegin || (size_t)length > outEnd - out.size()) { return false; }
+			size_t from = out.size() - back;
+			for(int i = 0; i < length; i++) { out.push_back(out[from++]); }
+		}
+	}
+
+	/// the code lengths of a dynamic block's two codes, and the codes.
+	bool readDynamicCodes(BitReader& in, Huffman& litLength, Huffman& distance) {
+		int const litLengthNum = (int)in.read(5) + 257, distanceNum = (int)in.read(5) + 1, codeLengthNum = (int)in.read(4) + 4;
+		// the header can count up to 288 and 32 codes, but only 286 and 30 are defined
+		if(litLengthNum > 286 || distanceNum > 30) { return false; }
+		static const int order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+		uint8_t codeLengths[19] = {0};
+		for(int i = 0; i < codeLengthNum; i++) { codeLengths[order[i]] = (uint8_t)in.read(3); }
+		Huffman codeLength;
+		if(!codeLength.build(codeLengths, 19)) { return false; }
+
+		uint8_t lengths[286 + 30] = {0};
+		for(int i = 0; i < litLengthNum + distanceNum;) {
+			int const symbol = codeLength.decode(in);
+			if(symbol < 0) { return false; }
+			if(symbol < 16) {
+				lengths[i++] = (uint8_t)symbol;
+				continue;
+			}
+			int repeat = 0;
+			uint8_t value = 0;
+			if(symbol == 16) {
+				if(i == 0) { return false; }
+				value = lengths[i - 1];
+				repeat = 3 + (int)in.read(2);
+			} else if(symbol == 17) {
+				repeat = 3 + (int)in.read(3);
+			} else {
+				repeat = 11 + (int)in.read(7);
+			}
+			if(i + repeat > litLengthNum + distanceNum) { return false; }
+			while(repeat-- > 0) { lengths[i++] = value; }
+		}
+		if(lengths[256] == 0) { return false; }
+		return litLength.build(lengths, litLengthNum) && distance.build(lengths + litLengthNum, distanceNum);
+	}
+
+	uint32_t readBigEndian(uint8_t const* p) { return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3]; }
+
+	uint8_t paeth(int const a, int const b, int const c) {
+		int const p = a + b - c, pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+		return (uint8_t)(pa <= pb && pa <= pc ? a : pb <= pc ? b : c);
+	}
+}
+
+bool Png::inflate(uint8_t const* data, size_t const size, std::vector<uint8_t>& out, size_t const maxSize) {
+	// zlib header: deflate, no preset dictionary, valid check bits
+	if(size < 6 || (data[0] & 0x0F) != 8 || (data[1] & 0x20) != 0 || ((data[0] << 8) | data[1]) % 31 != 0) { return false; }
+	size_t const outBegin = out.size(), outEnd = outBegin + std::min(maxSize, SIZE_MAX - outBegin);
+	BitReader in(data + 2, size - 2);
+	Huffman fixedLitLength, fixedDistance;
+	{
+		uint8_t lengths[288 + 30];
+		std::memset(lengths, 8, 144);
+		std::memset(lengths + 144, 9, 112);
+		std::memset(lengths + 256, 7, 24);
+		std::memset(lengths + 280, 8, 8);
+		std::memset(lengths + 288, 5, 30);
+		fixedLitLength.build(lengths, 288);
+		fixedDistance.build(lengths + 288, 30);
+	}
+	bool isFinal = false;
+	while(!isFinal) {
+		isFinal = in.read(1) != 0;
+		int const type = (int)in.read(2);
+		if(type == 0) {
+			in.alignToByte();
+			if(in.hasOverrun()) { return false; }
+			uint8_t const* p = in.bytePosition();
+			if(in.getEnd() - p < 4) { return false; }
+			int const length = p[0] | p[1] << 8, inverse = p[2] | p[3] << 8;
+			if((length ^ 0xFFFF) != inverse || in.getEnd() - p - 4 < length || (size_t)length > outEnd - out.size()) { return false; }
+			out.insert(out.end(), p + 4, p + 4 + length);
+			in.seek(p + 4 + length);
+		} else if(type == 1) {
+			if(!inflateBlock(in, fixedLitLength, fixedDistance, out, outBegin, outEnd)) { return false; }
+		} else if(type == 2) {
+			Huffman litLength, distance;
+			if(!readDynamicCodes(in, litLength, distance) || !inflateBlock(in, litLength, distance, out, outBegin, outEnd)) { return false; }
+		} else {
+			return false;
+		}
+		if(in.hasOverrun()) { return false; }
+	}
+
+	// the Adler-32 of the data, after the last block
+	in.alignToByte();
+	uint8_t const* p = in.bytePosition();
+	if(in.getEnd() - p < 4) { return false; }
+	uint32_t a = 1, b = 0;
+	for(size_t i = outBegin; i < out.size();) {
+		// 5552 bytes keep the sums below 2^32
+		size_t const n = std::min(out.size() - i, (size_t)5552);
+		for(size_t j = 0; j < n; j++) {
+			a += out[i + j];
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+		i += n;
+	}
+	return readBigEndian(p) == (b << 16 | a);
+}
+
+bool Png::decode(uint8_t const* data, size_t const size, Image& image) {
+	static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	if(size < 8 || std::memcmp(data, signature, 8) != 0) { return false; }
+
+	uint32_t width = 0, height = 0;
+	int depth = 0, color = -1;
+	std::vector<uint8_t> compressed, palette, transparency;
+	for(size_t pos = 8; pos + 12 <= size;) {
+		uint32_t const length = readBigEndian(data + pos);
+		if(length > size - pos - 12) { return false; }
+		uint8_t const* type = data + pos + 4;
+		uint8_t const* body = data + pos + 8;
+		pos += 12 + length;
+		if(std::memcmp(type, "IHDR", 4) == 0) {
+			if(length < 13) { return false; }
+			width = readBigEndian(body);
+			height = readBigEndian(body + 4);
+			depth = body[8];
+			color = body[9];
+			// compression, filter method, interlace
+			if(body[10] != 0 || body[11] != 0 || body[12] != 0) { return false; }
+		} else if(std::memcmp(type, "PLTE", 4) == 0) {
+			palette.assign(body, body + length);
+		} else if(std::memcmp(type, "tRNS", 4) == 0) {
+			transparency.assign(body, body + length);
+		} else if(std::memcmp(type, "IDAT", 4) == 0) {
+			compressed.insert(compressed.end(), body, body + length);
+		} else if(std::memcmp(type, "IEND", 4) == 0) {
+			break;
+		}
+	}
+
+	int channels = 0;
+	switch(color) {
+	case 0: channels = 1; break;
+	case 2: channels = 3; break;
+	case 3: channels = 1; break;
+	case 4: channels = 2; break;
+	case 6: channels = 4; break;
+	default: return false;
+	}
+	if(!(depth == 8 || (depth == 16 && color != 3))) { return false; }
+	if(width == 0 || height == 0 || width > 16384 || height > 16384) { return false; }
+	if(color == 3 && palette.size() < 3) { return false; }
+
+	int const bytesPerPixel = channels * depth / 8;
+	size_t const stride = (size_t)width * bytesPerPixel;
+	std::vector<uint8_t> raw;
+	size_t const rawSize = (stride + 1) * height;
+	// deflate packs at most 258 bytes in 2 bits, so the data bounds what it can hold,
+	// whatever the header says
+	raw.reserve(std::min(rawSize, compressed.size() * 1032));
+	if(!inflate(compressed.data(), compressed.size(), raw, rawSize) || raw.size() < rawSize) { return false; }
+
+	// undo the filters in place, row by row
+	for(uint32_t y = 0; y < height; y++) {
+		uint8_t* row = raw.data() + y * (stride + 1) + 1;
+		uint8_t const* prev = y > 0 ? row - (stride + 1) : nullptr;
+		int const filter = row[-1];
+		for(size_t i = 0; i < stride; i++) {
+			int const a = i >= (size_t)bytesPerPixel ? row[i - bytesPerPixel] : 0;
+			int const b = prev ? prev[i] : 0;
+			int const c = prev && i >= (size_t)bytesPerPixel ? prev[i - bytesPerPixel] : 0;
+			switch(filter) {
+			case 0: break;
+			case 1: row[i] = (uint8_t)(row[i] + a); break;
+			case 2: row[i] = (uint8_t)(row[i] + b); break;
+			case 3: row[i] = (uint8_t)(row[i] + ((a + b) >> 1)); break;
+			case 4: row[i] = (uint8_t)(row[i] + paeth(a, b, c)); break;
+			default: return false;
+			}
+		}
+	}
+
+	image.width = (int)width;
+	image.height = (int)height;
+	image.pixels.resize((size_t)width * height * 4);
+	int const step = depth / 8;
+	for(uint32_t y = 0; y < height; y++) {
+		uint8_t const* row = raw.data() + y * (stride + 1) + 1;
+		uint8_t* out = image.pixels.data() + (size_t)y * width * 4;
+		for(uint32_t x = 0; x < width; x++, out += 4) {
+			// the high byte of each 16-bit sample
+			uint8_t const* s = row + x * bytesPerPixel;
+			switch(color) {
+			case 0:
+				out[0] = out[1] = out[2] = s[0];
+				out[3] = 255;
+				break;
+			case 2:
+				out[0] = s[0];
+				out[1] = s[step];
+				out[2] = s[step * 2];
+				out[3] = 255;
+				break;
+			case 3:
+				if((size_t)s[0] * 3 + 2 >= palette.size()) { return false; }
+				std::memcpy(out, palette.data() + s[0] * 3, 3);
+				out[3] = s[0] < transparency.size() ? transparency[s[0]] : 255;
+				break;
+			case 4:
+				out[0] = out[1] = out[2] = s[0];
+				out[3] = s[step];
+				break;
+			default:
+				out[0] = s[0];
+				out[1] = s[step];
+				out[2] = s[step * 2];
+				out[3] = s[step * 3];
+				break;
+			}
+		}
+	}
+	return true;
+}
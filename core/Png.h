@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A PNG decoder with no dependencies, so that images can be decoded on any thread
+// (see AssetLoader.h), leaving only the upload to the render thread. It reads 8 and
+// 16-bit gray, gray with alpha, RGB and RGBA images and 8-bit palette images, not
+// interlaced: what tools/pack_atlas.py and the art tools used here write.
+namespace Png {
+	/// an image, RGBA, 4 bytes a pixel, row by row
+	struct Image {
+		int width = 0, height = 0;
+		std::vector<uint8_t> pixels;
+	};
+
+	/// @return false if data is not a PNG this can read; image is undefined then
+	bool decode(uint8_t const* data, size_t const size, Image& image);
+
+	/// inflate a zlib stream and append it to out.
+	/// @return false if the stream is broken or inflates to more than maxSize bytes
+	bool inflate(uint8_t const* data, size_t const size, std::vector<uint8_t>& out, size_t const maxSize = SIZE_MAX);
+}
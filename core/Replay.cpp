@@ -0,0 +1,121 @@
+#include "Replay.h"
+#include <cstring>
+
+namespace {
+	struct ReplayHeader {
+		char magic[8];
+		uint32_t version;
+		int32_t minesPerChunk, maxResidentChunks;
+		uint32_t reserved;
+		uint64_t seed;
+	};
+
+	char const replayMagic[8] = {'M', 'P', 'R', 'E', 'P', 'L', 'A', 'Y'};
+	/// 2: the tank steers by a table of sines (Tank.cpp), so version 1 games play differently
+	const uint32_t replayVersion = 2;
+	const int endOfRuns = 0xFF;
+}
+
+bool Replay::load(char const* path) {
+	std::FILE* const file = std::fopen(path, "rb");
+	if(!file) { return false; }
+	std::vector<uint8_t> data;
+	uint8_t buffer[4096];
+	for(size_t n; (n = std::fread(buffer, 1, sizeof(buffer), file)) > 0;) { data.insert(data.end(), buffer, buffer + n); }
+	std::fclose(file);
+
+	ReplayHeader header;
+	if(data.size() < sizeof(header)) { return false; }
+	std::memcpy(&header, data.data(), sizeof(header));
+	if(std::memcmp(header.magic, replayMagic, sizeof(header.magic)) != 0 || header.version != replayVersion) { return false; }
+
+	Replay r;
+	r.seed = header.seed;
+	r.minesPerChunk = header.minesPerChunk;
+	r.maxResidentChunks = header.maxResidentChunks;
+	uint8_t const* p = data.data() + sizeof(header);
+	uint8_t const* const end = data.data() + data.size();
+	while(p < end) {
+		int const keys = *p++;
+		if(keys == endOfRuns) {
+			if(end - p < 8) { break; }
+			std::memcpy(&r.stateHash, p, 8);
+			r.hasStateHash = true;
+			break;
+		}
+		uint32_t length = 0;
+		int shift = 0;
+		bool isComplete = false;
+		while(p < end && shift < 32) {
+			uint8_t const b = *p++;
+			length |= (uint32_t)(b & 0x7F) << shift;
+			shift += 7;
+			if(!(b & 0x80)) {
+				isComplete = true;
+				break;
+			}
+		}
+		// a run cut off by a crash is dropped
+		if(!isComplete) { break; }
+		if(length > Replay::maxFrameNum - r.keys.size()) { return false; }
+		r.keys.insert(r.keys.end(), length, (uint8_t)keys);
+	}
+	*this = std::move(r);
+	return true;
+}
+
+ReplayRecorder::~ReplayRecorder() {
+	if(file) {
+		writeRun();
+		std::fclose(file);
+	}
+}
+
+bool ReplayRecorder::open(char const* path, uint64_t const seed, int const minesPerChunk, int const maxResidentChunks) {
+	if(file) { std::fclose(file); }
+	runKeys = 0;
+	runLength = 0;
+	frameNum = 0;
+	file = std::fopen(path, "wb");
+	if(!file) { return false; }
+	ReplayHeader header;
+	std::memcpy(header.magic, replayMagic, sizeof(header.magic));
+	header.version = replayVersion;
+	header.minesPerChunk = minesPerChunk;
+	header.maxResidentChunks = maxResidentChunks;
+	header.reserved = 0;
+	header.seed = seed;
+	return std::fwrite(&header, sizeof(header), 1, file) == 1 && std::fflush(file) == 0;
+}
+
+bool ReplayRecorder::writeRun() {
+	if(runLength == 0) { return true; }
+	uint8_t bytes[6];
+	int n = 0;
+	bytes[n++] = (uint8_t)runKeys;
+	for(uint32_t v = runLength;; v >>= 7) {
+		bytes[n++] = (uint8_t)((v & 0x7F) | (v >= 0x80 ? 0x80 : 0));
+		if(v < 0x80) { break; }
+	}
+	runLength = 0;
+	return std::fwrite(bytes, 1, n, file) == (size_t)n && std::fflush(file) == 0;
+}
+
+void ReplayRecorder::record(int const keys) {
+	if(!file || frameNum == Replay::maxFrameNum) { return; }
+	frameNum++;
+	if(keys != runKeys) {
+		writeRun();
+		runKeys = keys;
+	}
+	runLength++;
+}
+
+bool ReplayRecorder::finish(uint64_t const stateHash) {
+	if(!file) { return false; }
+	uint8_t const endByte = (uint8_t)endOfRuns;
+	bool ok = writeRun() && std::fwrite(&endByte, 1, 1, file) == 1 && std::fwrite(&stateHash, 8, 1, file) == 1;
+	ok = std::fclose(file) == 0 && ok;
+	file = nullptr;
+	return ok;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// A game is its seed and the keys held on every frame. The file is a header, then
+// runs of frames with the same keys (a key byte and a varint frame count), and, if
+// the game ended cleanly, an end byte 0xFF and the GameSession::hashState() it
+// ended on. A 30 minute game is a few KB.
+
+/// a recorded game, to play again with GameSession.
+struct Replay {
+	/// the longest game a replay holds: a day at 60 frames a second. A file with more
+	/// frames is not loaded, so a corrupt run length cannot take gigabytes.
+	static const uint32_t maxFrameNum = 24 * 60 * 60 * 60;
+
+	uint64_t seed = 0;
+	int minesPerChunk = 0, maxResidentChunks = 0;
+	/// the Tank::Key bits held on each frame
+	std::vector<uint8_t> keys;
+	/// the state the game ended on, if the recording was finished
+	bool hasStateHash = false;
+	uint64_t stateHash = 0;
+
+	/// read a file ReplayRecorder wrote. An unfinished one plays up to its last run.
+	/// @return false if the file cannot be read, is not a replay or holds more than
+	/// maxFrameNum frames; nothing is changed then
+	bool load(char const* path);
+};
+
+/// writes a Replay while the game is played.
+class ReplayRecorder {
+	std::FILE* file = nullptr;
+	int runKeys = 0;
+	uint32_t runLength = 0, frameNum = 0;
+
+	ReplayRecorder(ReplayRecorder const&);
+	ReplayRecorder& operator=(ReplayRecorder const&);
+
+	bool writeRun();
+
+public:
+	ReplayRecorder() {}
+	/// closes the file unfinished.
+	~ReplayRecorder();
+
+	/// start a recording of a game of GameSession(seed, minesPerChunk, maxResidentChunks).
+	/// @return false if the file cannot be written
+	bool open(char const* path, uint64_t const seed, int const minesPerChunk, int const maxResidentChunks);
+
+	/// the keys of the next frame. A run is written out when the keys change, so a
+	/// crash loses the frames since the last change only. Frames past
+	/// Replay::maxFrameNum are not recorded.
+	void record(int const keys);
+
+	/// write the last run and the state the game ended on, and close the file.
+	/// @return false if the recording could not be written
+	bool finish(uint64_t const stateHash);
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "Field.h"
+#include <deque>
+#include <vector>
+
+/// the looks of cells waiting to be shown, in world cells. In progressive mode a
+/// change is held back by its wave (see FieldTypes::DirtyCell), so a reveal or a
+/// chain reaction is shown one ring per frame from where it started; otherwise
+/// everything is shown on the next frame.
+class RevealQueue {
+public:
+	struct Change {
+		int x, y;
+		FieldTypes::Visual visual;
+		/// the frame it was queued in, to tell it from later changes of the cell
+		long long frame;
+	};
+
+private:
+	bool isProgressive = false;
+	/// the front wave is shown next
+	std::deque<std::vector<Change>> waves;
+
+public:
+	bool getProgressive() const { return isProgressive; }
+	void setProgressive(bool const progressive) { isProgressive = progressive; }
+
+	/// queue a change of a field whose cell (0, 0) is at (originX, originY) of the world.
+	void push(FieldTypes::VisualChange const& c, int const originX, int const originY, long long const frame) {
+		size_t const wave = isProgressive ? (size_t)c.wave : 0;
+		if(waves.size() <= wave) { waves.resize(wave + 1); }
+		waves[wave].push_back(Change{originX + c.x, originY + c.y, c.visual, frame});
+	}
+
+	/// the changes to show this frame, in the order they were queued.
+	/// @return false if nothing is waiting
+	bool popFrame(std::vector<Change>& out) {
+		out.clear();
+		if(waves.empty()) { return false; }
+		out.swap(waves.front());
+		waves.pop_front();
+		return true;
+	}
+
+	bool isEmpty() const { return waves.empty(); }
+};
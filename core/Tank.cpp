@@ -0,0 +1,92 @@
+#include "Tank.h"
+#include <cstring>
+
+namespace {
+	/// sin of 0 .. 90 degrees, as floats. The tank steers by this table and not by
+	/// std::sin and std::cos, whose last bits vary with the C library, so that a
+	/// game replays to the same state on every platform.
+	const float quarterSines[91] = {
+		0.0f, 0.0174524058f, 0.0348994955f, 0.0523359552f, 0.0697564706f, 0.0871557444f, 0.104528464f, 0.121869341f,
+		0.139173105f, 0.156434461f, 0.173648179f, 0.190808997f, 0.207911685f, 0.224951059f, 0.241921902f, 0.258819044f,
+		0.275637358f, 0.29237169f, 0.309017003f, 0.325568169f, 0.342020154f, 0.35836795f, 0.37460658f, 0.390731126f,
+		0.406736642f, 0.42261827f, 0.438371152f, 0.453990489f, 0.469471574f, 0.484809607f, 0.5f, 0.515038073f,
+		0.529919267f, 0.544639051f, 0.559192896f, 0.57357645f, 0.587785244f, 0.601815045f, 0.615661502f, 0.629320383f,
+		0.642787635f, 0.656059027f, 0.669130623f, 0.681998372f, 0.694658399f, 0.707106769f, 0.719339788f, 0.7313537f,
+		0.74314481f, 0.754709601f, 0.766044438f, 0.777145982f, 0.788010776f, 0.798635483f, 0.809017003f, 0.819152057f,
+		0.829037547f, 0.838670552f, 0.848048091f, 0.857167304f, 0.866025388f, 0.874619722f, 0.882947564f, 0.891006529f,
+		0.898794055f, 0.906307817f, 0.91354543f, 0.920504868f, 0.927183867f, 0.933580399f, 0.939692616f, 0.945518553f,
+		0.95105654f, 0.956304729f, 0.96126169f, 0.965925813f, 0.970295727f, 0.974370062f, 0.978147626f, 0.981627166f,
+		0.98480773f, 0.987688363f, 0.990268052f, 0.992546141f, 0.994521916f, 0.99619472f, 0.997564077f, 0.99862951f,
+		0.999390841f, 0.99984771f, 1.0f
+	};
+
+	/// sin of a heading in whole degrees, 0 .. 359.
+	float sinOf(int const degrees) {
+		return degrees <= 90 ? quarterSines[degrees] : degrees <= 180 ? quarterSines[180 - degrees]
+			: degrees <= 270 ? -quarterSines[degrees - 180] : -quarterSines[360 - degrees];
+	}
+	float cosOf(int const degrees) { return sinOf((degrees + 90) % 360); }
+}
+
+void Tank::move(int const keys) {
+	speed = 1.0f;
+	prevExpectedDirection = expectedDirection;
+	if(keys & keyLeft) {
+		if(keys & keyUp) {
+			expectedDirection = 5.0f;
+		} else if(keys & keyDown) {
+			expectedDirection = 3.0f;
+		} else {
+			expectedDirection = 4.0f;
+		}
+
+	} else if(keys & keyRight) {
+		if(keys & keyUp) {
+			expectedDirection = 7.0f;
+		} else if(keys & keyDown) {
+			expectedDirection = 1.0f;
+		} else {
+			expectedDirection = 0.0f;
+		}
+
+	} else {
+		if(keys & keyUp) {
+			expectedDirection = 6.0f;
+		} else if(keys & keyDown) {
+			expectedDirection = 2.0f;
+		} else {
+			speed = 0.0f;
+		}
+	}
+
+	if(prevExpectedDirection != expectedDirection) {isRotating = true;}
+
+	// turn the shorter way, 4 degrees a frame, and the other way round from straight behind
+	int const expectedAngle = (int)expectedDirection * 45;
+	int const turn = (expectedAngle - angle + 360) % 360;
+	if(isRotating && turn > 4 && turn < 356) {
+		angle = (angle + (turn < 180 ? 4 : 356)) % 360;
+	} else {
+		angle = expectedAngle;
+		isRotating = false;
+	}
+	x = (float)(x + (double)cosOf(angle) * speed);
+	y = (float)(y + (double)sinOf(angle) * speed);
+}
+
+uint64_t Tank::hashState() const {
+	uint64_t h = 0xCBF29CE484222325ULL;
+	auto const mix = [&](void const* p, size_t const n) {
+		uint8_t bytes[8];
+		std::memcpy(bytes, p, n);
+		for(size_t i = 0; i < n; i++) { h = (h ^ bytes[i]) * 0x100000001B3ULL; }
+	};
+	mix(&x, sizeof(x));
+	mix(&y, sizeof(y));
+	mix(&expectedDirection, sizeof(expectedDirection));
+	mix(&angle, sizeof(angle));
+	mix(&speed, sizeof(speed));
+	uint8_t const rotating = isRotating ? 1 : 0;
+	mix(&rotating, 1);
+	return h;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+
+/// the player's tank: where it is and where it is turning to, moved a frame at a time
+/// by the arrow keys held. It only depends on the keys, so a game can be replayed
+/// from them (see Replay.h).
+class Tank {
+public:
+	/// the keys that steer a tank, as bits of one byte
+	enum Key {
+		keyLeft = 1, keyRight = 2, keyUp = 4, keyDown = 8
+	};
+
+private:
+	float x = 0.0f, y = 0.0f;
+	float prevExpectedDirection = 0.0f, expectedDirection = 0.0f;
+	bool isRotating = false;
+	/// the heading in whole degrees, 0 .. 359
+	int angle = 0;
+	float speed = 0.0f;
+
+public:
+	/// move one frame: head for the direction of the keys held (Key bits), turning
+	/// 4 degrees a frame, at 1 pixel a frame; stop when no arrow key is held.
+	void move(int const keys);
+
+	/// the position in pixels; cell (0, 0) is at the origin.
+	float getX() const { return x; }
+	float getY() const { return y; }
+	/// the heading in degrees, clockwise from the x axis, 0 .. 359.
+	double getAngle() const { return angle; }
+
+	/// FNV-1a over the bits of the tank's state.
+	uint64_t hashState() const;
+};
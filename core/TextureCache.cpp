@@ -0,0 +1,75 @@
+#include "TextureCache.h"
+#include <cstring>
+
+namespace {
+	struct FileHeader {
+		char magic[8];
+		uint32_t version, byteOrder;
+		uint32_t entryNum, reserved;
+		uint64_t indexOffset;
+	};
+
+	struct Entry {
+		/// the PNG as the game opens it, e.g. "img/atlas.png"; NUL padded
+		char sourcePath[32];
+		uint64_t sourceHash;
+		uint32_t width, height, pitch, format;
+		uint64_t pixelsOffset;
+	};
+
+	char const fileMagic[8] = {'M', 'P', 'T', 'E', 'X', 'C', 'A', 0};
+	const uint32_t fileVersion = 1;
+	const uint32_t fileByteOrder = 0x01020304;
+	/// 4 bytes a pixel, R G B A
+	const uint32_t formatRgba8 = 1;
+}
+
+bool TextureCache::open(char const* path) {
+	entryNum = 0;
+	if(!file.open(path) || file.getSize() < sizeof(FileHeader)) {
+		file.close();
+		return false;
+	}
+	FileHeader header;
+	std::memcpy(&header, file.getData(), sizeof(header));
+	uint64_t const size = file.getSize();
+	bool ok = std::memcmp(header.magic, fileMagic, sizeof(header.magic)) == 0 && header.version == fileVersion && header.byteOrder == fileByteOrder
+		&& header.indexOffset >= sizeof(FileHeader) && header.indexOffset <= size && header.entryNum <= (size - header.indexOffset) / sizeof(Entry);
+	for(uint32_t i = 0; i < header.entryNum && ok; i++) {
+		Entry e;
+		std::memcpy(&e, file.getData() + header.indexOffset + i * sizeof(Entry), sizeof(e));
+		uint64_t const bytes = (uint64_t)e.pitch * e.height;
+		ok = e.format == formatRgba8 && e.sourcePath[sizeof(e.sourcePath) - 1] == 0 && e.width > 0 && e.height > 0 && e.width <= 16384 && e.height <= 16384
+			&& e.pitch >= e.width * 4 && e.pixelsOffset % 64 == 0 && e.pixelsOffset <= size && bytes <= size - e.pixelsOffset;
+	}
+	if(!ok) {
+		file.close();
+		return false;
+	}
+	entryNum = header.entryNum;
+	return true;
+}
+
+bool TextureCache::find(std::string const& sourcePath, uint8_t const* source, size_t const sourceSize, Texture& texture) const {
+	if(!isOpen()) { return false; }
+	FileHeader header;
+	std::memcpy(&header, file.getData(), sizeof(header));
+	for(uint32_t i = 0; i < entryNum; i++) {
+		Entry e;
+		std::memcpy(&e, file.getData() + header.indexOffset + i * sizeof(Entry), sizeof(e));
+		if(sourcePath != e.sourcePath) { continue; }
+		if(e.sourceHash != hashSource(source, sourceSize)) { return false; }
+		texture.pixels = file.getData() + e.pixelsOffset;
+		texture.width = (int)e.width;
+		texture.height = (int)e.height;
+		texture.pitch = (int)e.pitch;
+		return true;
+	}
+	return false;
+}
+
+uint64_t TextureCache::hashSource(uint8_t const* source, size_t const size) {
+	uint64_t h = 0xCBF29CE484222325ULL;
+	for(size_t i = 0; i < size; i++) { h = (h ^ source[i]) * 0x100000001B3ULL; }
+	return h;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Textures cooked ahead of time by tools/cook_textures.py, as the RGBA pixels a
+// texture is uploaded from, so that startup maps one file instead of decoding PNGs.
+// The file is a header, an index of entries, then the pixels of every entry, 64-byte
+// aligned. An entry keeps the hash of the PNG it was cooked from; when the PNG has
+// changed since, the entry is not used and the PNG is decoded as before.
+
+/// a cooked texture file, mapped.
+class TextureCache {
+	MappedFile file;
+	uint32_t entryNum = 0;
+
+public:
+	/// pixels in the mapping
+	struct Texture {
+		uint8_t const* pixels;
+		int width, height, pitch;
+	};
+
+	/// map the file and check its header and index.
+	/// @return false if it cannot be mapped or is not a texture cache of this version
+	bool open(char const* path);
+	bool isOpen() const { return file.getData() != nullptr; }
+
+	/// the texture cooked from sourcePath, if source, the file as it is now, is what
+	/// it was cooked from. Any thread.
+	/// @return false if there is none or it is stale
+	bool find(std::string const& sourcePath, uint8_t const* source, size_t const sourceSize, Texture& texture) const;
+
+	/// FNV-1a over the bytes of a source file, as tools/cook_textures.py does.
+	static uint64_t hashSource(uint8_t const* source, size_t const size);
+};
@@ -0,0 +1,317 @@
+#include "core/ChunkedWorld.h"
+#include "core/Field.h"
+#include "core/Replay.h"
+#include "core/RevealQueue.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <random>
+
+// Runs the field rules without ace: no window, no frame cap.
+// usage: minepanzer_headless [games] [ticksPerGame] [width] [height] [mines] [seed]
+//        minepanzer_headless --check-reveal [fields] [seed]
+//        minepanzer_headless --check-seams
+//        minepanzer_headless --check-load [path]
+//        minepanzer_headless --check-replay [path]
+// Game g is played on the field of seed + g, so a run can be repeated with its seed.
+// --check-reveal opens an empty cell on each of the fields and checks that a
+// progressive RevealQueue shows the reveal a ring per frame, as the game does.
+// --check-seams opens a region across a chunk seam with exploding cells on both
+// sides of it, and checks that the opening ends and reaches the whole region.
+// --check-load saves played fields and loads them back through path, then
+// corrupts the header and the planes of a save one way at a time and checks that
+// each is rejected, leaving the field it was loaded into as it was.
+// --check-replay records a replay and loads it back, then checks that a replay
+// whose runs add up to more than Replay::maxFrameNum frames is rejected.
+namespace {
+	/// the ring each cell the reveal from (x, y) should open is on, or -1 for the
+	/// others: a queue-driven breadth-first search through the eight neighbors,
+	/// spreading from the empty cells only.
+	std::vector<int> expectedRings(Field const& field, int const x, int const y) {
+		int const width = field.getWidth(), height = field.getHeight();
+		std::vector<int> rings((size_t)width * height, -1);
+		std::deque<int> todo(1, y * width + x);
+		rings[todo[0]] = 0;
+		while(!todo.empty()) {
+			int const c = todo.front();
+			todo.pop_front();
+			if(field.getNeighborMineNum(c % width, c / width) != 0) { continue; }
+			for(int dy = -1; dy < 2; dy++) for(int dx = -1; dx < 2; dx++) {
+				int const nx = c % width + dx, ny = c / width + dy;
+				if(nx < 0 || ny < 0 || nx >= width || ny >= height || field.getStatus(nx, ny) != Field::Status::free || rings[ny * width + nx] >= 0) { continue; }
+				rings[ny * width + nx] = rings[c] + 1;
+				todo.push_back(ny * width + nx);
+			}
+		}
+		return rings;
+	}
+
+	/// @return the number of fields whose reveal did not come out ring by ring
+	int checkReveal(int const fields, uint64_t const seed) {
+		int const width = 96, height = 80, mineNum = width * height / 14;
+		int failures = 0;
+		long long cells = 0, frames = 0;
+		for(int f = 0; f < fields; f++) {
+			Field field(width, height, mineNum, seed + f);
+			// an empty cell near the middle
+			int start = -1;
+			for(int d = 0; d < width && start < 0; d++) {
+				for(int c = 0; c < width * height && start < 0; c++) {
+					int const cx = c % width, cy = c / width;
+					if(std::max(std::abs(cx - width / 2), std::abs(cy - height / 2)) == d && field.getStatus(cx, cy) == Field::Status::free && field.getNeighborMineNum(cx, cy) == 0) { start = c; }
+				}
+			}
+			if(start < 0) { continue; }
+			int const x = start % width, y = start / width;
+			std::vector<int> const expected = expectedRings(field, x, y);
+
+			std::vector<FieldTypes::VisualChange> changes;
+			field.takeVisualChanges(changes);
+			changes.clear();
+			field.openCell(x, y, true);
+			field.takeVisualChanges(changes);
+			RevealQueue queue;
+			queue.setProgressive(true);
+			for(auto const& c : changes) { queue.push(c, 0, 0, 1); }
+
+			std::vector<int> shown((size_t)width * height, -1);
+			std::vector<RevealQueue::Change> frame;
+			bool ok = true;
+			for(int ring = 0; queue.popFrame(frame); ring++, frames++) {
+				for(auto const& c : frame) {
+					int const i = c.y * width + c.x;
+					ok = ok && shown[i] < 0;
+					shown[i] = ring;
+					cells++;
+				}
+			}
+			ok = ok && shown == expected;
+			if(!ok) {
+				failures++;
+				std::cout << "field of seed " << seed + f << ": the reveal from (" << x << ", " << y << ") is not shown ring by ring\n";
+			}
+		}
+		std::cout << "reveal: " << fields << " fields, " << cells << " cells in " << frames << " frames, " << failures << " out of ring order\n";
+		return failures;
+	}
+
+	/// @return true if the opening across the seam ended as it should
+	bool checkSeams() {
+		// two empty chunks, each with an exploding cell on the seam, facing opened
+		// cells of the other once the region is open
+		ChunkedWorld world(1, 0, 64);
+		world.setBlastRadius(0);
+		world.showArea(CellRect{0, 0, 2 * ChunkedWorld::chunkSize, ChunkedWorld::chunkSize});
+		auto& a = *world.getChunk(0, 0);
+		auto& b = *world.getChunk(1, 0);
+		a.layMine(ChunkedWorld::chunkSize - 1, 30);
+		b.layMine(0, 40);
+		a.explodeMine(ChunkedWorld::chunkSize - 1, 30);
+		b.explodeMine(0, 40);
+		world.openCell(10, 10, true);
+
+		int unopened = 0;
+		for(int c = 0; c < 2; c++) {
+			auto const& chunk = *world.getChunk(c, 0);
+			for(int y = 0; y < ChunkedWorld::chunkSize; y++) for(int x = 0; x < ChunkedWorld::chunkSize; x++) {
+				if(chunk.getStatus(x, y) == ChunkedWorld::ChunkField::Status::free && !chunk.isOpenedByFriend(x, y)) { unopened++; }
+			}
+		}
+		std::cout << "seams: the opening across the seam ended, " << unopened << " free cells left unopened\n";
+		return unopened == 0;
+	}
+
+	std::vector<char> readFile(char const* path) {
+		std::ifstream in(path, std::ios::binary);
+		return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+
+	bool writeFile(char const* path, std::vector<char> const& bytes) {
+		std::ofstream out(path, std::ios::binary);
+		out.write(bytes.data(), bytes.size());
+		return (bool)out;
+	}
+
+	/// @return the number of saves that did not load back as they were, plus the
+	/// corrupted ones that loaded
+	int checkLoad(char const* path) {
+		int failures = 0;
+		// played fields, and a chunk with mines on its padding ring from its neighbors
+		std::mt19937 eng(3);
+		for(int f = 0; f < 20; f++) {
+			Field field(100, 70, 900, f);
+			for(int i = 0; i < 40; i++) {
+				int const x = eng() % 100, y = eng() % 70;
+				if(i % 5 == 0) { field.explodeMine(x, y); } else { field.openCell(x, y, i % 2 == 0); }
+				field.tick();
+			}
+			Field loaded(1, 1, 0, 1);
+			if(!field.save(path) || !loaded.load(path) || loaded.hashState() != field.hashState()) { failures++; }
+		}
+		ChunkedWorld world(2, 400, 64);
+		world.showArea(CellRect{0, 0, 3 * ChunkedWorld::chunkSize, 3 * ChunkedWorld::chunkSize});
+		ChunkedWorld::ChunkField chunk = *world.getChunk(1, 1);
+		if(!world.getChunk(1, 1)->save(path) || !chunk.load(path) || chunk.hashState() != world.getChunk(1, 1)->hashState()) { failures++; }
+		int const played = failures;
+
+		int const w = 100, h = 70;
+		Field field(w, h, 900, 7);
+		field.save(path);
+		std::vector<char> const saved = readFile(path);
+		uint64_t planesOffset;
+		std::memcpy(&planesOffset, saved.data() + 56, sizeof(planesOffset));
+		size_t const bitPlaneBytes = (size_t)((h + 2 + 15) & ~15) * (w / 64 + 2) * 8;
+		// the byte and bit of cell (x, y) of bit plane p, as Field.cpp lays them out
+		auto const bitOf = [&](int const p, int const x, int const y) {
+			size_t const bit = ((size_t)(y + 1) * (w / 64 + 2) + (x + 64) / 64) * 64 + (x + 64) % 64;
+			return std::make_pair((size_t)planesOffset + p * bitPlaneBytes + bit / 8, 1 << (bit % 8));
+		};
+		enum { mined, obstacle, exploding, openedByFriend, openedByEnemy, toOpenByFriend, toOpenByEnemy, zeros };
+		int minedX = 0, minedY = 0;
+		for(int c = 0; c < w * h; c++) {
+			if(field.getStatus(c % w, c / w) == Field::Status::mined) { minedX = c % w, minedY = c / w; }
+		}
+
+		struct Corruption {
+			char const* what;
+			std::function<void(std::vector<char>&)> apply;
+		};
+		auto const setInt = [](std::vector<char>& b, size_t const offset, int32_t const v) { std::memcpy(b.data() + offset, &v, sizeof(v)); };
+		auto const flip = [&](int const p, int const x, int const y) {
+			return [=](std::vector<char>& b) { auto const at = bitOf(p, x, y); b[at.first] ^= (char)at.second; };
+		};
+		Corruption const corruptions[] = {
+			{"a blast radius of 200", [&](std::vector<char>& b) { setInt(b, 28, 200); }},
+			{"a mine count of -1", [&](std::vector<char>& b) { setInt(b, 24, -1); }},
+			{"no obstacle in a guard word", flip(obstacle, -1, 5)},
+			{"no obstacle in the padding row", flip(obstacle, 3, h)},
+			{"no obstacle right of a row", flip(obstacle, w, 8)},
+			{"a mine two cells right of a row", flip(mined, w + 1, 8)},
+			{"an opened cell right of a row", flip(openedByFriend, w + 2, 3)},
+			{"a cell to open below the field", flip(toOpenByEnemy, 10, h)},
+			{"a zero cell above the field", flip(zeros, 3, -1)},
+			{"an exploding cell in a guard word", flip(exploding, -1, 20)},
+			{"an obstacle on a mine", flip(obstacle, minedX, minedY)},
+			{"an exploding mine", flip(exploding, minedX, minedY)},
+			{"a zero cell on a mine", flip(zeros, minedX, minedY)},
+			{"a mine count of 9", [&](std::vector<char>& b) {
+				int const i = 8 + minedX;
+				char& byte = b[(size_t)planesOffset + 8 * bitPlaneBytes + (size_t)(minedY + 1) * (4 + ((w + 8) & ~7) / 2) + i / 2];
+				byte = (char)((byte & ~(0xF << (i % 2 * 4))) | (9 << (i % 2 * 4)));
+			}},
+		};
+		Field target(20, 20, 30, 9);
+		uint64_t const targetHash = target.hashState();
+		for(auto const& c : corruptions) {
+			std::vector<char> bytes = saved;
+			c.apply(bytes);
+			bool const isLoaded = writeFile(path, bytes) && target.load(path);
+			if(isLoaded || target.hashState() != targetHash) {
+				failures++;
+				std::cout << "a save with " << c.what << (isLoaded ? " loaded\n" : " changed the field\n");
+				target = Field(20, 20, 30, 9);
+			}
+		}
+		std::remove(path);
+		std::cout << "load: " << played << " of 21 saves did not load back, " << failures - played << " of "
+			<< sizeof(corruptions) / sizeof(corruptions[0]) << " corrupted saves got through\n";
+		return failures;
+	}
+
+	/// @return true if the recorded replay loaded back and the oversized ones did not
+	bool checkReplay(char const* path) {
+		ReplayRecorder recorder;
+		if(!recorder.open(path, 5, 410, 64)) { return false; }
+		std::vector<uint8_t> keys;
+		for(int f = 0; f < 1000; f++) {
+			keys.push_back((uint8_t)(f / 70 % 16));
+			recorder.record(keys.back());
+		}
+		Replay replay;
+		bool const isRecorded = recorder.finish(0x1234) && replay.load(path) && replay.keys == keys && replay.stateHash == 0x1234;
+
+		// the header and the end of the recording, around runs of frames
+		std::vector<char> const bytes = readFile(path);
+		size_t const headerSize = 32;
+		std::vector<char> const header(bytes.begin(), bytes.begin() + headerSize), ending(bytes.end() - 9, bytes.end());
+		auto const run = [](int const keys, uint32_t const length) {
+			std::vector<char> r(1, (char)keys);
+			for(uint32_t v = length;; v >>= 7) {
+				r.push_back((char)((v & 0x7F) | (v >= 0x80 ? 0x80 : 0)));
+				if(v < 0x80) { break; }
+			}
+			return r;
+		};
+		uint32_t const half = Replay::maxFrameNum / 2 + 1;
+		std::vector<std::vector<char>> const runs[] = {
+			{run(1, 0xFFFFFFFF)},
+			{run(1, Replay::maxFrameNum + 1)},
+			{run(1, half), run(2, half)},
+		};
+		int oversized = 0;
+		for(auto const& r : runs) {
+			std::vector<char> file = header;
+			for(auto const& one : r) { file.insert(file.end(), one.begin(), one.end()); }
+			file.insert(file.end(), ending.begin(), ending.end());
+			if(writeFile(path, file) && replay.load(path)) { oversized++; }
+		}
+		// and a game of exactly the longest length loads
+		std::vector<char> longest = header;
+		for(auto const& one : {run(1, half), run(2, Replay::maxFrameNum - half)}) { longest.insert(longest.end(), one.begin(), one.end()); }
+		longest.insert(longest.end(), ending.begin(), ending.end());
+		bool const isLongestLoaded = writeFile(path, longest) && replay.load(path) && replay.keys.size() == Replay::maxFrameNum;
+		std::remove(path);
+
+		std::cout << "replay: the recording " << (isRecorded ? "loaded back" : "DID NOT LOAD BACK") << ", " << oversized << " of "
+			<< sizeof(runs) / sizeof(runs[0]) << " oversized replays loaded, the longest one " << (isLongestLoaded ? "loaded" : "DID NOT LOAD") << "\n";
+		return isRecorded && oversized == 0 && isLongestLoaded;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	if(argc > 1 && std::strcmp(argv[1], "--check-reveal") == 0) {
+		int const fields = argc > 2 ? std::atoi(argv[2]) : 200;
+		uint64_t const seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1;
+		return checkReveal(fields, seed) == 0 ? 0 : 1;
+	}
+	if(argc > 1 && std::strcmp(argv[1], "--check-seams") == 0) { return checkSeams() ? 0 : 1; }
+	if(argc > 1 && std::strcmp(argv[1], "--check-load") == 0) { return checkLoad(argc > 2 ? argv[2] : "minepanzer_check.field") == 0 ? 0 : 1; }
+	if(argc > 1 && std::strcmp(argv[1], "--check-replay") == 0) { return checkReplay(argc > 2 ? argv[2] : "minepanzer_check.replay") ? 0 : 1; }
+
+	int const games = argc > 1 ? std::atoi(argv[1]) : 100;
+	int const ticksPerGame = argc > 2 ? std::atoi(argv[2]) : 60;
+	int const fieldWidth = argc > 3 ? std::atoi(argv[3]) : 20;
+	int const fieldHeight = argc > 4 ? std::atoi(argv[4]) : 20;
+	int const mineNum = argc > 5 ? std::atoi(argv[5]) : 40;
+	uint64_t const seed = argc > 6 ? std::strtoull(argv[6], nullptr, 10) : ((uint64_t)std::random_device()() << 32) | std::random_device()();
+	std::cout << "seed " << seed << "\n";
+
+	std::mt19937 eng(0);
+	std::uniform_int_distribution<int> distX(0, fieldWidth - 1), distY(0, fieldHeight - 1);
+	long long explosions = 0, processedCells = 0;
+
+	auto const begin = std::chrono::steady_clock::now();
+	for(int g = 0; g < games; g++) {
+		Field field(fieldWidth, fieldHeight, mineNum, seed + g);
+		for(int t = 0; t < ticksPerGame; t++) {
+			if(field.openCell(distX(eng), distY(eng), (t & 1) == 0)) { explosions++; }
+			field.tick();
+			field.clearDirtyCells();
+			processedCells += field.getProcessedCellCount();
+		}
+	}
+	auto const end = std::chrono::steady_clock::now();
+
+	double const ms = std::chrono::duration<double, std::milli>(end - begin).count();
+	std::cout << fieldWidth << "x" << fieldHeight << ", " << mineNum << " mines: " << games << " games x " << ticksPerGame << " ticks in " << ms << " ms ("
+		<< (ms * 1000.0 / ((double)games * ticksPerGame)) << " us/tick), " << explosions << " explosions, "
+		<< ((double)processedCells / ((double)games * ticksPerGame)) << " cells processed/tick\n";
+	return 0;
+}
@@ -1,10 +1,21 @@
 
 #include "ace.h"
+#include "AtlasRects.h"
+#include "core/AssetLoader.h"
+#include "core/GameSession.h"
+#include "core/Replay.h"
+#include "core/RevealQueue.h"
 #include "cassert"
 #include <memory>
 #include <array>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <random>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <stdexcept>
 #ifdef _DEBUG
 
 #pragma comment(lib, "Debug/ace_engine.lib")
@@ -18,239 +29,279 @@ using namespace ace;
 
 template<typename T> using sp = std::shared_ptr<T>;
 
-static const int fieldWidth = 20;
-static const int fieldHeight = 20;
-static const int mineNum = 40;
-
 namespace ImgManager {
 	void setTexture2D(sp<Texture2D>& tex, char const* file) {
 		tex = Engine::GetGraphics()->CreateTexture2D(ToAString(file).c_str());
 	}
-	sp<Texture2D> closedCell, minedCell, obstacleCell, player, digTarget;
+	/// every sprite in one texture (see tools/pack_atlas.py); objects draw their
+	/// sprite of it by source rect.
+	sp<Texture2D> atlas;
+	char const* atlasPath = "img/atlas.png";
+	/// the cells, each a texture of its own: a Chip2D draws its whole texture.
+	sp<Texture2D> closedCell, minedCell, obstacleCell;
 	std::array<sp<Texture2D>, 9> freeCells;
-	void init() {
-		setTexture2D(closedCell, "img/closedCell.png");
-		setTexture2D(minedCell, "img/minedCell.png");
-		setTexture2D(obstacleCell, "img/obstacleCell.png");
-		setTexture2D(freeCells[0], "img/freeCell.png");
-		setTexture2D(freeCells[1], "img/numCell1.png");
-		setTexture2D(freeCells[2], "img/numCell2.png");
-		setTexture2D(freeCells[3], "img/numCell3.png");
-		setTexture2D(freeCells[4], "img/numCell4.png");
-		setTexture2D(freeCells[5], "img/numCell5.png");
-		setTexture2D(freeCells[6], "img/numCell6.png");
-		setTexture2D(freeCells[7], "img/numCell7.png");
-		setTexture2D(freeCells[8], "img/numCell8.png");
-		setTexture2D(player, "img/player.png");
-		setTexture2D(digTarget, "img/digTarget.png");
-	}
-}
-
 
+	/// the cell textures, and the sprites they are cut from
+	sp<Texture2D>* const cells[] = {&closedCell, &minedCell, &obstacleCell,
+		&freeCells[0], &freeCells[1], &freeCells[2], &freeCells[3], &freeCells[4], &freeCells[5], &freeCells[6], &freeCells[7], &freeCells[8]};
+	Atlas::SpriteId const cellSprites[] = {Atlas::closedCell, Atlas::minedCell, Atlas::obstacleCell,
+		Atlas::freeCell, Atlas::numCell1, Atlas::numCell2, Atlas::numCell3, Atlas::numCell4, Atlas::numCell5, Atlas::numCell6, Atlas::numCell7, Atlas::numCell8};
+	int const cellNum = 12;
+
+	/// where the sprite is in the atlas
+	RectF srcOf(Atlas::SpriteId const id) {
+		auto const& s = Atlas::sprites[id];
+		return RectF((float)s.x, (float)s.y, (float)s.width, (float)s.height);
+	}
 
-class Cell: public TextureObject2D {
-private:
-	int neighborMineNum = 0;
-public:
-	enum class Status {
-		free,
-		mined, // minedAobstacleAexploding͑S}bvœ
-		obstacle,
-		exploding // minedexploding_[Wfree
-	};
-private:
-	Status status = Status::free;
-
-	void changeTexture() {
-		switch(status) {
-		case Status::mined:
-			SetTexture(ImgManager::closedCell); // TODO: for debug
-			break;
-		case Status::obstacle:
-			SetTexture(ImgManager::obstacleCell);
-			break;
-		case Status::exploding:
-			SetTexture(ImgManager::minedCell);
-			break;
-		case Status::free:
-			if(!isOpenedByFriend) {
-				SetTexture(ImgManager::closedCell);
-				return;
-			}
-			if(neighborMineNum == 0) {
-				SetTexture(ImgManager::freeCells[0]);
-			} else {
-				SetTexture(ImgManager::freeCells.at(neighborMineNum));
-			}
-			break;
-		default:
-			break;
-		}
+	/// a texture of RGBA pixels whose rows are pitch bytes apart, or nullptr.
+	sp<Texture2D> createTexture(uint8_t const* pixels, int const width, int const height, int const pitch) {
+		auto tex = Engine::GetGraphics()->CreateEmptyTexture2D(width, height, TEXTURE_FORMAT_R8G8B8A8_UNORM);
+		TextureLockInfomation to;
+		if(!tex || !tex->Lock(to)) { return nullptr; }
+		for(int y = 0; y < height; y++) { std::memcpy((uint8_t*)to.Pixels + y * to.Pitch, pixels + y * pitch, width * 4); }
+		tex->Unlock();
+		return tex;
 	}
-public:
-	bool isOpenedByFriend = false;
-	bool isOpenedByEnemy = false;
 
-	// Op
-	bool isToOpenByFriend = false;
-	bool isToOpenByEnemy = false;
-	
-	/// lay a mine on this cell.
-	/// @return true iff succeeded
-	bool layMine() {
-		if(status != Status::free) { return false; }
-		isOpenedByEnemy = isOpenedByFriend = false;
-		status = Status::mined;
-		changeTexture();
-		
+	/// the files to load at startup (see LoadingScene)
+	std::vector<std::string> files() { return std::vector<std::string>(1, atlasPath); }
+	/// the textures cooked by tools/cook_textures.py
+	TextureCache cache;
+	char const* cachePath = "img/textures.cache";
+
+	/// make the textures of the loaded atlas: the atlas itself, and the cells cut out
+	/// of its pixels. Render thread only.
+	/// @return false if the asset is not the atlas, was not decoded or does not hold the sprites
+	bool upload(AssetLoader::Asset const& asset) {
+		if(asset.path != atlasPath || !asset.isDecoded) { return false; }
+		for(auto const& s : Atlas::sprites) {
+			if(s.x + s.width > asset.width || s.y + s.height > asset.height) { return false; }
+		}
+		atlas = createTexture(asset.pixels, asset.width, asset.height, asset.pitch);
+		if(!atlas) { return false; }
+		for(int i = 0; i < cellNum; i++) {
+			auto const& s = Atlas::sprites[cellSprites[i]];
+			*cells[i] = createTexture(asset.pixels + (size_t)s.y * asset.pitch + s.x * 4, s.width, s.height, asset.pitch);
+			if(!*cells[i]) { return false; }
+		}
 		return true;
-		
 	}
 
-	int getNeighborMineNum() const {return neighborMineNum;}
-	void incNeighborMineNum() { neighborMineNum++; }
-	void decNeighborMineNum() { neighborMineNum--; }
+	/// load the textures with the engine, a file at a time on this thread, for when
+	/// the atlas cannot be decoded or uploaded here.
+	void loadFromFiles() {
+		setTexture2D(atlas, atlasPath);
+		for(int i = 0; i < cellNum; i++) { setTexture2D(*cells[i], (std::string("img/") + Atlas::sprites[cellSprites[i]].name + ".png").c_str()); }
+		std::cout << "textures: " << cellNum + 1 << " files loaded by the engine\n";
+	}
+}
 
-	Status getStatus() const {return status;}
 
 
-	void explode() {
-		if(status != Status::mined) {return;}
-		status = Status::exploding;
-		changeTexture();
-	}
-	void openByFriend() {
-		if(status == Status::mined){
-			explode();
-			return;
-		}
-		if(status == Status::free) {
-			isOpenedByFriend = true;
-			changeTexture();
-			return;
-		}
+/// the texture a cell that looks so is drawn with, as its index in ImgManager::cells.
+int visualCell(FieldTypes::Visual const visual) {
+	switch(visual) {
+	case FieldTypes::Visual::mined:
+		return 0; // closedCell. TODO: for debug
+	case FieldTypes::Visual::obstacle:
+		return 2;
+	case FieldTypes::Visual::exploding:
+		return 1;
+	case FieldTypes::Visual::closed:
+		return 0;
+	default:
+		int const n = (int)visual - (int)FieldTypes::Visual::open0;
+		if(n < 0 || n > 8) { throw std::out_of_range("visualCell"); }
+		return 3 + n;
 	}
+}
 
-	void openByEnemy() {
-		if(status == Status::mined) {
-			explode();
-			return;
-		}
-		if(status == Status::free) {
-			isOpenedByEnemy = true;
-			return;
-		}
-	}
-	void endExplosion() {
-		if(status != Status::exploding) { return; }
-		status = Status::free;
-		isOpenedByEnemy = isOpenedByFriend = true;
-		changeTexture();
-	}
-	void OnStart() override {
-		SetScale(Vector2DF(0.25f, 0.25f));
-		changeTexture();
-		
-	}
-	
-};
 
-class Field {
+/// draws the world around the camera with a fixed pool of blocks of blockSize x
+/// blockSize cells, a Chip2D per cell. The pool covers the camera rect and marginCells
+/// around it; block (bx, by) of the world always lives in slot (bx mod poolWidth,
+/// by mod poolHeight), so a block scrolling out on one side is re-bound to the one
+/// scrolling in on the other. The objects, the chips and the work per frame are the
+/// same on a map of any size.
+///
+/// A Chip2D draws its whole texture (its src is where it goes in the map), so the
+/// cells cannot be drawn from the atlas. Instead the chips are kept in one MapObject2D
+/// per cell texture, by the look they show, and a chip moves to another map when its
+/// look changes: each map draws with one texture, so the layer binds one texture per
+/// look on screen a frame, not one per change of texture from chip to chip.
+///
+/// The chunks' render-diff queues (BasicField::takeVisualChanges) are drained once a
+/// frame, before drawing, and applied in one pass. Every chip remembers the look it
+/// was last given, so a change is applied only if it is a real transition and only
+/// if its cell is in the pool: a cell is retextured at most once a frame.
+class WorldView {
+	static const int blockSize = 16;
+	static const int marginCells = 4;
+
+	struct Block {
+		// one per cell of the block, row by row, with the look it was last given and
+		// the frame of the change that gave it
+		std::vector<sp<Chip2D>> chips;
+		std::vector<FieldTypes::Visual> shown;
+		std::vector<long long> shownAt;
+		// the block of the world shown, if isBound
+		int bx, by;
+		bool isBound;
+	};
 
-	using CellArray = std::array<std::array<sp<Cell>, fieldWidth>, fieldHeight>;
-	CellArray cellArray;
+	ChunkedWorld& world;
 	sp<Layer2D> parentLayer;
+	int poolWidth, poolHeight;
+	std::vector<Block> pool;
+	// one per ImgManager::cells, drawing the chips of that texture in world pixels,
+	// and the number of chips in each
+	std::vector<sp<MapObject2D>> cellMaps;
+	std::vector<int> cellChipNums;
+
+	RevealQueue revealQueue;
+	std::vector<FieldTypes::VisualChange> changes;
+	std::vector<RevealQueue::Change> shownChanges;
+	long long frameCount = 0;
+	// since the last takeStats()
+	long long changeNum = 0, retextureNum = 0;
+
+	static int floorDiv(int const a, int const b) { return a >= 0 ? a / b : (a + 1) / b - 1; }
+	static int floorMod(int const a, int const b) { return ((a % b) + b) % b; }
+
+	Block& slotOf(int const bx, int const by) { return pool.at(floorMod(by, poolHeight) * poolWidth + floorMod(bx, poolWidth)); }
+
+	/// the look of a cell of the world; closed if its chunk is not resident.
+	FieldTypes::Visual visualAt(int const x, int const y) {
+		int const cx = ChunkedWorld::chunkOf(x), cy = ChunkedWorld::chunkOf(y);
+		auto const* field = world.getChunk(cx, cy);
+		if(!field) { return FieldTypes::Visual::closed; }
+		return field->getVisual(x - cx * ChunkedWorld::chunkSize, y - cy * ChunkedWorld::chunkSize);
+	}
 
-public:
-
-	Field(sp<Layer2D> parent) : parentLayer(parent){
-		
+	/// give chip i of the block a look, as of a change in that frame.
+	void show(Block& block, int const i, FieldTypes::Visual const visual, long long const frame) {
+		// a change queued before the chip was bound or changed again is out of date
+		if(frame < block.shownAt.at(i)) { return; }
+		block.shownAt.at(i) = frame;
+		if(block.shown.at(i) == visual) { return; }
+		int const from = visualCell(block.shown.at(i)), to = visualCell(visual);
+		block.shown.at(i) = visual;
+		if(from == to) { return; }
+		auto const& chip = block.chips.at(i);
+		cellMaps.at(from)->RemoveChip(chip);
+		chip->SetTexture(ImgManager::cells[to]->get());
+		cellMaps.at(to)->AddChip(chip);
+		cellChipNums.at(from)--;
+		cellChipNums.at(to)++;
+		retextureNum++;
+	}
 
-		for(int iy = 0; iy < fieldHeight; iy++) for(int ix = 0; ix < fieldWidth; ix++) {
-			auto& e = cellArray.at(iy).at(ix);
-			e = std::make_shared<Cell>();
-			e->SetPosition(Vector2DF(ix * 246.0f / 4.0f, iy * 246.0f / 4.0f));
-			parent->AddObject(e);
+	void bind(Block& block, int const bx, int const by) {
+		block.bx = bx;
+		block.by = by;
+		block.isBound = true;
+		for(int iy = 0; iy < blockSize; iy++) for(int ix = 0; ix < blockSize; ix++) {
+			int const x = bx * blockSize + ix, y = by * blockSize + iy;
+			// a chip is drawn over its src rect in the map, its whole texture scaled to fit
+			block.chips.at(iy * blockSize + ix)->SetSrc(RectF(x * cellPitch, y * cellPitch, cellPitch, cellPitch));
+			show(block, iy * blockSize + ix, visualAt(x, y), frameCount);
 		}
+	}
 
-		// n𖄂߂
-		
-		std::random_device rnd;
-		std::vector<unsigned int> v = {rnd(), rnd(), rnd()};
-		std::mt19937 eng(std::seed_seq(v.begin(), v.end()));
-		std::uniform_int_distribution<int> distX(0, fieldWidth - 1), distY(0, fieldHeight - 1);
-		for(int i = 0; i < mineNum;) {
-			if(layMine(distX(eng), distY(eng))) { i++; }
+	/// unbind the blocks inside the chunk, to be bound again with its cells.
+	void unbindChunk(ChunkedWorld::ChunkPos const& c) {
+		for(auto& block : pool) {
+			if(ChunkedWorld::chunkOf(block.bx * blockSize) == c.x && ChunkedWorld::chunkOf(block.by * blockSize) == c.y) { block.isBound = false; }
 		}
-		
-		// openCell(3, 3, true);
-
 	}
 
-	sp<Cell> getCell(int const x, int const y) const { return cellArray.at(y).at(x); }
-	/// lay a mine
-	/// @return true iff succeeded to mine.
-	bool layMine(int const x, int const y) {
-		
-		if(x < 0 || x > fieldWidth || y < 0 || y > fieldHeight || !cellArray.at(y).at(x)->layMine()) { return false; }
-		
-		for(int iy = -1; iy < 2; iy++) for(int ix = -1; ix < 2; ix++) {
-			if((x != ix || y != iy) && x + ix < fieldWidth && x + ix >= 0 && y + iy < fieldHeight && y + iy >= 0 ) {
-				cellArray.at(y + iy).at(x + ix)->incNeighborMineNum();
+public:
+	/// a pool for a camera of viewWidth x viewHeight pixels.
+	WorldView(ChunkedWorld& w, sp<Layer2D> parent, int const viewWidth, int const viewHeight) : world(w), parentLayer(parent) {
+		// enough blocks to cover the camera and the margins wherever the camera is
+		float const blockPitch = blockSize * cellPitch;
+		poolWidth = (int)std::ceil((viewWidth + (2 * marginCells + 1) * cellPitch) / blockPitch) + 1;
+		poolHeight = (int)std::ceil((viewHeight + (2 * marginCells + 1) * cellPitch) / blockPitch) + 1;
+		pool.resize(poolWidth * poolHeight);
+		for(int i = 0; i < ImgManager::cellNum; i++) {
+			cellMaps.push_back(std::make_shared<MapObject2D>());
+			parentLayer->AddObject(cellMaps.back());
+		}
+		int const closed = visualCell(FieldTypes::Visual::closed);
+		cellChipNums.assign(ImgManager::cellNum, 0);
+		cellChipNums.at(closed) = (int)pool.size() * blockSize * blockSize;
+		for(auto& block : pool) {
+			block.chips.resize(blockSize * blockSize);
+			for(auto& chip : block.chips) {
+				chip = Engine::GetGraphics()->CreateChip2D();
+				chip->SetTexture(ImgManager::cells[closed]->get());
+				cellMaps.at(closed)->AddChip(chip);
 			}
+			block.shown.assign(blockSize * blockSize, FieldTypes::Visual::closed);
+			block.shownAt.assign(blockSize * blockSize, 0);
+			block.bx = block.by = 0;
+			block.isBound = false;
 		}
-		return true;
-
 	}
 
-	// nN
-	void explodeMine(int const x, int const y) {
-		if(x < 0 || x > fieldWidth || y < 0 || y > fieldHeight) { return; }
-		if(cellArray.at(y).at(x)->getStatus() == Cell::Status::mined) {
-			cellArray.at(y).at(x)->explode();
-			for(int iy = -1; iy < 2; iy++) for(int ix = -1; ix < 2; ix++) {
-				if((x != ix || y != iy) && x + ix < fieldWidth && x + ix >= 0 && y + iy < fieldHeight && y + iy >= 0) {
-					cellArray.at(y + iy).at(x + ix)->decNeighborMineNum();
-				}
-			}
-		}
+	~WorldView() {
+		for(auto const& map : cellMaps) { parentLayer->RemoveObject(map); }
 	}
 
-	/// open the cell and set the neighbors' status to be nextOpen 
-	/// @return true iff the cell is mined
-	bool openCell(int const x, int const y, bool const isFriend) {
-		if(x < 0 || x >= fieldWidth || y < 0 || y >= fieldHeight) { return false; }
-		if(cellArray.at(y).at(x)->getStatus() == Cell::Status::mined) {
-			explodeMine(x, y);
-			return true;
+	/// show reveals ring by ring, one per frame, instead of all at once.
+	void setProgressiveReveal(bool const progressive) { revealQueue.setProgressive(progressive); }
+
+	/// follow the world's chunk events, drain the render-diff queue of every chunk
+	/// and apply this frame's share of it. Call once per frame, after the world
+	/// ticked and before showArea().
+	void update() {
+		frameCount++;
+		for(auto const& c : world.getEvictedChunks()) { unbindChunk(c); }
+		for(auto const& c : world.getLoadedChunks()) { unbindChunk(c); }
+		world.clearChunkEvents();
+
+		for(auto const& c : world.getResidentChunks()) {
+			changes.clear();
+			world.getChunk(c.x, c.y)->takeVisualChanges(changes);
+			changeNum += changes.size();
+			for(auto const& d : changes) { revealQueue.push(d, c.x * ChunkedWorld::chunkSize, c.y * ChunkedWorld::chunkSize, frameCount); }
 		}
 
-		if(cellArray.at(y).at(x)->getStatus() != Cell::Status::free) { return false; }
-		if(isFriend) {
-			cellArray.at(y).at(x)->openByFriend();
-		} else {
-			cellArray.at(y).at(x)->openByEnemy();
+		if(!revealQueue.popFrame(shownChanges)) { return; }
+		for(auto const& c : shownChanges) {
+			int const bx = floorDiv(c.x, blockSize), by = floorDiv(c.y, blockSize);
+			auto& block = slotOf(bx, by);
+			if(!block.isBound || block.bx != bx || block.by != by) { continue; }
+			show(block, (c.y - by * blockSize) * blockSize + c.x - bx * blockSize, c.visual, c.frame);
 		}
+	}
 
-		// ZȂΎ͂̃ZAIɊJ
-		if(cellArray.at(y).at(x)->getNeighborMineNum() > 0) {return false;}
-		for(int iy = -1; iy < 2; iy++) for(int ix = -1; ix < 2; ix++) {
-			if((x != ix || y != iy) && x + ix < fieldWidth && x + ix >= 0 && y + iy < fieldHeight && y + iy >= 0) {
-				if(isFriend) {
-					cellArray.at(y + iy).at(x + ix)->isToOpenByFriend = true;
-				} else {
-					cellArray.at(y + iy).at(x + ix)->isToOpenByEnemy = true;
-				}
-			}
+	/// bind the pool to the blocks around the camera rect (in pixels).
+	void showArea(RectI const& camera) {
+		int const bx0 = floorDiv((int)std::floor(camera.X / cellPitch) - marginCells, blockSize);
+		int const by0 = floorDiv((int)std::floor(camera.Y / cellPitch) - marginCells, blockSize);
+		for(int by = by0; by < by0 + poolHeight; by++) for(int bx = bx0; bx < bx0 + poolWidth; bx++) {
+			auto& block = slotOf(bx, by);
+			if(!block.isBound || block.bx != bx || block.by != by) { bind(block, bx, by); }
 		}
-
-		return false;
 	}
 
-
-
+	/// the map objects on the layer, and the cells they draw: the objects one per cell would take.
+	int getObjectNum() const { return (int)cellMaps.size(); }
+	int getCellNum() const { return (int)pool.size() * blockSize * blockSize; }
+	/// the cell textures bound to draw a frame: one per map with chips in it.
+	int getTextureBindNum() const { return (int)std::count_if(cellChipNums.begin(), cellChipNums.end(), [](int const n) { return n > 0; }); }
+
+	/// the changes drained from the chunks and the chips retextured since the last call.
+	std::pair<long long, long long> takeStats() {
+		auto const stats = std::make_pair(changeNum, retextureNum);
+		changeNum = retextureNum = 0;
+		return stats;
+	}
 };
 
+
 class EngineProvider {
 public:
 	EngineProvider() {
@@ -270,73 +321,24 @@ public:
 
 };
 
+/// draws the session's tank.
 class Player: public TextureObject2D {
 private:
-	Keyboard *input;
-	float prevExpectedDirection = 0.0f, expectedDirection = 0.0f;
-	bool isRotating = false;
-	double angle = 0.0;
-	float speed = 0.0f;
-protected:
-	void move() {
-		speed = 1.0f;
-		prevExpectedDirection = expectedDirection;
-		if(!((int)input->GetKeyState(Keys::Left) & 1)) {
-			if(!((int)input->GetKeyState(Keys::Up) & 1)) {
-				expectedDirection = 5.0f;
-			} else if(!((int)input->GetKeyState(Keys::Down) & 1)) {
-				expectedDirection = 3.0f;
-			} else {
-				expectedDirection = 4.0f;
-			}
-
-		} else if(!((int)input->GetKeyState(Keys::Right) & 1)) {
-			if(!((int)input->GetKeyState(Keys::Up) & 1)) {
-				expectedDirection = 7.0f;
-			} else if(!((int)input->GetKeyState(Keys::Down) & 1)) {
-				expectedDirection = 1.0f;
-			} else {
-				expectedDirection = 0.0f;
-			}
-
-		} else {
-			if(!((int)input->GetKeyState(Keys::Up) & 1)) {
-				expectedDirection = 6.0f;
-			} else if(!((int)input->GetKeyState(Keys::Down) & 1)) {
-				expectedDirection = 2.0f;
-			} else {
-				speed = 0.0f;
-			}
-		}
-
-		if(prevExpectedDirection != expectedDirection) {isRotating = true;}
-
-		const double expectedAngle = expectedDirection * 45.0;
-		if(isRotating && abs(expectedAngle - angle) > 4.0f) {
-			if(sin(((expectedAngle - angle) * 2.0 * PI) / 360.0) > 0) {
-				angle += 4.0;
-			} else {
-				angle -= 4.0;
-			}
-		} else {
-			angle = expectedAngle;
-			isRotating = false;
-		}
-		SetAngle((float)angle);
-		const auto pos = GetPosition();
-		SetPosition(Vector2DF((float)(pos.X + cos(angle * 2.0 * PI / 360.0) * speed), (float)(pos.Y + sin(angle * 2.0 * PI / 360.0) * speed)));
-	}
+	Tank const& tank;
 public:
+	Player(Tank const& t) : tank(t) {}
+
 	virtual void OnStart() override {
-		input = Engine::GetKeyboard();
-		SetTexture(ImgManager::player);
+		SetTexture(ImgManager::atlas);
+		SetSrc(ImgManager::srcOf(Atlas::player));
 		SetCenterPosition(Vector2DF(256.0f, 256.0f));
 		SetPosition(Vector2DF(0.0f, 0.0f));
 	}
 	
 	virtual void OnUpdate() override{
 		SetScale(Vector2DF(1.0f, 1.0f));
-		move();
+		SetAngle((float)tank.getAngle());
+		SetPosition(Vector2DF(tank.getX(), tank.getY()));
 		SetScale(Vector2DF(0.25f, 0.25f));
 
 	}
@@ -346,13 +348,28 @@ public:
 class GameScene: public Scene {
 	sp<Layer2D> fieldLayer = sp<Layer2D>(new Layer2D()), objectLayer = sp<Layer2D>(new Layer2D()), effectLayer = sp<Layer2D>(new Layer2D());
 	sp<CameraObject2D> cameraf = sp<CameraObject2D>(new CameraObject2D()), camerao = sp<CameraObject2D>(new CameraObject2D());;
-	sp<Field> field;
-	sp<Player> player = sp<Player>(new Player());
+	sp<GameSession> session;
+	sp<WorldView> worldView;
+	sp<Player> player;
 	Keyboard *input;
+	ReplayRecorder recorder;
+	static char const* replayPath;
+	/// frames between reports of the objects on the field layer
+	static const int reportInterval = 600;
+
+	/// the arrow keys held, as Tank::Key bits
+	int readKeys() const {
+		int keys = 0;
+		if(!((int)input->GetKeyState(Keys::Left) & 1)) { keys |= Tank::keyLeft; }
+		if(!((int)input->GetKeyState(Keys::Right) & 1)) { keys |= Tank::keyRight; }
+		if(!((int)input->GetKeyState(Keys::Up) & 1)) { keys |= Tank::keyUp; }
+		if(!((int)input->GetKeyState(Keys::Down) & 1)) { keys |= Tank::keyDown; }
+		return keys;
+	}
 
 public:
-	GameScene(): Scene() {
-		ImgManager::init();
+	/// the textures must be loaded (see LoadingScene).
+	GameScene(int const minesPerChunk, int const maxResidentChunks): Scene() {
 		input = Engine::GetKeyboard();
 		AddLayer(fieldLayer);
 		AddLayer(objectLayer);
@@ -376,38 +393,116 @@ public:
 
 		objectLayer->AddObject(camerao);
 		fieldLayer->AddObject(cameraf);
-		field = std::make_shared<Field>(fieldLayer);
-
+		std::random_device rnd;
+		uint64_t const seed = ((uint64_t)rnd() << 32) | rnd();
+		session = std::make_shared<GameSession>(seed, minesPerChunk, maxResidentChunks);
+		// every game is recorded, to play it again with minepanzer_replay, e.g. for a bug report
+		std::cout << "world seed " << seed << ", " << minesPerChunk << " mines per chunk\n";
+		if(!recorder.open(replayPath, seed, minesPerChunk, maxResidentChunks)) { std::cout << "cannot record the game to " << replayPath << "\n"; }
+		worldView = std::make_shared<WorldView>(session->getWorld(), fieldLayer, GameSession::viewWidth, GameSession::viewHeight);
+		// reveals and chain reactions spread out a ring per frame
+		worldView->setProgressiveReveal(true);
+
+		player = std::make_shared<Player>(session->getTank());
 		objectLayer->AddObject(player);
 
 	}
 
 	void OnUpdating() override {
-		for(int iy = 0; iy < fieldHeight; iy++) for(int ix = 0; ix < fieldWidth; ix++) {
-			auto& e = field->getCell(ix, iy);
-			if(e->isToOpenByFriend) { e->isToOpenByFriend = false; field->openCell(ix, iy, true); }
-			if(e->isToOpenByEnemy) { e->isToOpenByEnemy = false; field->openCell(ix, iy, false); }
+		int const keys = readKeys();
+		recorder.record(keys);
+		session->step(keys);
+		for(auto const& b : session->getHits()) {
+			std::cout << "tank hit by a blast at (" << b.x << ", " << b.y << "), " << session->getHitCount() << " hits\n";
+		}
 
+		auto const& tank = session->getTank();
+		auto const cameraSrc = RectI((int)(tank.getX() + 0.5f) - 400, (int)(tank.getY() + 0.5f) - 300, 800, 600);
+		cameraf->SetSrc(cameraSrc);
+		camerao->SetSrc(cameraSrc);
+		// the session has loaded the chunks a screen ahead of the camera
+		worldView->update();
+		worldView->showArea(cameraSrc);
+		if(session->getFrameCount() % reportInterval == 0) {
+			auto const stats = worldView->takeStats();
+			std::cout << "field layer: " << worldView->getObjectNum() << " objects drawing " << worldView->getCellNum() << " cells with "
+				<< worldView->getTextureBindNum() << " texture binds a frame; "
+				<< stats.first << " cell changes, " << stats.second << " chips retextured in " << reportInterval << " frames\n";
 		}
-		auto pPos = player->GetPosition();
+	}
 
-		cameraf->SetSrc(RectI((int)(pPos.X + 0.5f) - 400, (int)(pPos.Y + 0.5f) - 300, 800, 600));
-		camerao->SetSrc(RectI((int)(pPos.X + 0.5f) - 400, (int)(pPos.Y + 0.5f) - 300, 800, 600));
+	/// end the recording of the game with the state it ended on.
+	void finishRecording() {
+		uint64_t const hash = session->hashState();
+		if(recorder.finish(hash)) { std::cout << "game recorded to " << replayPath << ", " << session->getFrameCount() << " frames, state " << std::hex << hash << std::dec << "\n"; }
+	}
+};
+
+char const* GameScene::replayPath = "last.replay";
 
 
+/// draws a progress bar while an AssetLoader reads and decodes the textures on
+/// worker threads, and uploads them here on the render thread as they come in.
+/// Prints the startup report when they are all up.
+class LoadingScene: public Scene {
+	sp<Layer2D> layer = sp<Layer2D>(new Layer2D());
+	sp<TextureObject2D> bar = sp<TextureObject2D>(new TextureObject2D());
+	AssetLoader loader;
+	bool isUploaded = true, isLoadingDone = false;
+	static const int barWidth = 600, barHeight = 16;
+
+public:
+	/// textures cooked from the PNGs as they are now come from ImgManager::cache.
+	LoadingScene(): Scene(), loader(ImgManager::files(), 0, ImgManager::cache.open(ImgManager::cachePath) ? &ImgManager::cache : nullptr) {
+		AddLayer(layer);
+		// a white pixel, stretched to the progress
+		uint8_t const white[] = {255, 255, 255, 255};
+		bar->SetTexture(ImgManager::createTexture(white, 1, 1, 4));
+		bar->SetPosition(Vector2DF((800 - barWidth) / 2.0f, (600 - barHeight) / 2.0f));
+		bar->SetScale(Vector2DF(0.0f, (float)barHeight));
+		layer->AddObject(bar);
 	}
 
+	void OnUpdating() override {
+		if(isLoadingDone) { return; }
+		for(auto const asset : loader.takeReady()) {
+			auto const begin = std::chrono::steady_clock::now();
+			isUploaded = ImgManager::upload(*asset) && isUploaded;
+			asset->uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+			asset->image = Png::Image();
+			asset->pixels = nullptr;
+		}
+		bar->SetScale(Vector2DF((float)barWidth * loader.getTakenNum() / loader.getAssetNum(), (float)barHeight));
+		if(!loader.isDone()) { return; }
 
+		loader.printReport(std::cout);
+		if(!isUploaded) {
+			std::cout << "the atlas could not be decoded or uploaded\n";
+			ImgManager::loadFromFiles();
+		}
+		isLoadingDone = true;
+	}
+
+	/// true once the textures are up
+	bool isDone() const { return isLoadingDone; }
 };
 
 
 int main() {
 	EngineProvider engineProvider;
-	sp<Scene> gameScene = sp<Scene>(new GameScene());
-	Engine::ChangeScene(gameScene);
+	sp<LoadingScene> loadingScene = sp<LoadingScene>(new LoadingScene());
+	sp<Scene> scene = loadingScene;
+	Engine::ChangeScene(scene);
+	sp<GameScene> gameScene;
 	while(Engine::DoEvents()) {
 		//std::cout << Engine::GetCurrentFPS() << "\n";
 		Engine::Update();
+		if(!gameScene && loadingScene->isDone()) {
+			gameScene = sp<GameScene>(new GameScene(410, 64));
+			scene = gameScene;
+			Engine::ChangeScene(scene);
+		}
 	}
+	if(gameScene) { gameScene->finishRecording(); }
 
 }
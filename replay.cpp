@@ -0,0 +1,82 @@
+#include "core/GameSession.h"
+#include "core/Replay.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+// Plays a recorded game again without ace, as fast as it goes, and checks that it
+// ends on the state the game did.
+// usage: minepanzer_replay <file> [frames]
+//        minepanzer_replay --record <file> [minutes] [seed]
+// With frames, it stops after that many and prints the hash there, to find the frame
+// two runs part at. --record drives the tank around at random for that many minutes
+// of 60 frames and records it, with the final hash, to have something to replay.
+namespace {
+	/// the game MinePanzer plays: GameScene(410, 64)
+	const int minesPerChunk = 410, maxResidentChunks = 64;
+
+	int record(char const* path, int const minutes, uint64_t const seed) {
+		GameSession session(seed, minesPerChunk, maxResidentChunks);
+		ReplayRecorder recorder;
+		if(!recorder.open(path, seed, minesPerChunk, maxResidentChunks)) {
+			std::cerr << "cannot write " << path << "\n";
+			return 1;
+		}
+		// hold a random set of arrow keys for a random half second to three seconds
+		std::mt19937 eng((uint32_t)seed);
+		std::uniform_int_distribution<int> distKeys(0, 15), distHold(30, 180);
+		long long const frameNum = (long long)minutes * 60 * 60;
+		int keys = 0, held = 0;
+		for(long long f = 0; f < frameNum; f++) {
+			if(held-- == 0) {
+				keys = distKeys(eng);
+				held = distHold(eng);
+			}
+			recorder.record(keys);
+			session.step(keys);
+		}
+		if(!recorder.finish(session.hashState())) {
+			std::cerr << "cannot write " << path << "\n";
+			return 1;
+		}
+		std::cout << "recorded " << frameNum << " frames, state " << std::hex << session.hashState() << std::dec << "\n";
+		return 0;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	if(argc < 2) {
+		std::cerr << "usage: minepanzer_replay <file> [frames]\n       minepanzer_replay --record <file> [minutes] [seed]\n";
+		return 2;
+	}
+	if(std::strcmp(argv[1], "--record") == 0) {
+		if(argc < 3) { return 2; }
+		return record(argv[2], argc > 3 ? std::atoi(argv[3]) : 30, argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 1);
+	}
+
+	Replay replay;
+	if(!replay.load(argv[1])) {
+		std::cerr << "cannot read " << argv[1] << "\n";
+		return 1;
+	}
+	size_t const frameNum = argc > 2 ? std::min((size_t)std::atoll(argv[2]), replay.keys.size()) : replay.keys.size();
+	std::cout << "seed " << replay.seed << ", " << replay.minesPerChunk << " mines per chunk, " << frameNum << " of " << replay.keys.size() << " frames\n";
+
+	auto const begin = std::chrono::steady_clock::now();
+	GameSession session(replay.seed, replay.minesPerChunk, replay.maxResidentChunks);
+	for(size_t f = 0; f < frameNum; f++) { session.step(replay.keys[f]); }
+	double const ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+	uint64_t const hash = session.hashState();
+	std::cout << "played in " << ms << " ms (x" << frameNum * 1000.0 / 60.0 / ms << " real time), " << session.getHitCount() << " hits, tank at ("
+		<< session.getTank().getX() << ", " << session.getTank().getY() << ")\n"
+		<< "state " << std::hex << hash << std::dec;
+	if(frameNum < replay.keys.size() || !replay.hasStateHash) {
+		std::cout << "\n";
+		return 0;
+	}
+	std::cout << (hash == replay.stateHash ? ", as recorded\n" : ", NOT AS RECORDED\n");
+	return hash == replay.stateHash ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""Cooks the textures the game loads into img/textures.cache, as the RGBA pixels
+they are uploaded from, so that startup maps one file instead of decoding PNGs
+(see core/TextureCache.h). Every entry keeps the FNV-1a hash of its PNG; the game
+decodes the PNG instead when it no longer matches, so a stale cache only costs time.
+
+Standard library only. Run it after tools/pack_atlas.py:
+
+    python3 tools/cook_textures.py [--check] [img/file.png ...]
+
+By default it cooks img/atlas.png. With --check it writes nothing and fails if the
+cache is missing or out of date.
+"""
+import os
+import struct
+import sys
+
+from pack_atlas import ROOT, read_png
+
+CACHE = os.path.join(ROOT, 'img', 'textures.cache')
+SOURCES = ['img/atlas.png']
+
+MAGIC = b'MPTEXCA\0'
+VERSION = 1
+BYTE_ORDER = 0x01020304
+FORMAT_RGBA8 = 1
+HEADER = struct.Struct('<8sIIIIQ')
+ENTRY = struct.Struct('<32sQIIIIQ')
+ALIGN = 64
+
+
+def fnv1a(data):
+    h = 0xCBF29CE484222325
+    for b in data:
+        h = ((h ^ b) * 0x100000001B3) & 0xFFFFFFFFFFFFFFFF
+    return h
+
+
+def align(n):
+    return (n + ALIGN - 1) // ALIGN * ALIGN
+
+
+def build(sources):
+    entries, pixels = [], []
+    offset = align(HEADER.size + ENTRY.size * len(sources))
+    for source in sources:
+        name = source.replace(os.sep, '/').encode()
+        if len(name) >= 32:
+            raise ValueError('%s: the path is too long for the index' % source)
+        data = open(os.path.join(ROOT, source), 'rb').read()
+        width, height, rgba = read_png(os.path.join(ROOT, source))
+        entries.append(ENTRY.pack(name, fnv1a(data), width, height, width * 4, FORMAT_RGBA8, offset))
+        pixels.append(bytes(rgba) + b'\0' * (align(len(rgba)) - len(rgba)))
+        offset += len(pixels[-1])
+    head = HEADER.pack(MAGIC, VERSION, BYTE_ORDER, len(sources), 0, HEADER.size) + b''.join(entries)
+    return head + b'\0' * (align(len(head)) - len(head)) + b''.join(pixels)
+
+
+def main():
+    args = [a for a in sys.argv[1:] if a != '--check']
+    cache = build(args or SOURCES)
+    if '--check' in sys.argv[1:]:
+        if not os.path.exists(CACHE) or open(CACHE, 'rb').read() != cache:
+            print('%s is out of date; run tools/cook_textures.py' % os.path.relpath(CACHE, ROOT))
+            return 1
+        return 0
+    with open(CACHE, 'wb') as f:
+        f.write(cache)
+    print('cooked %d textures into %s, %.1f MB' % (len(args or SOURCES), os.path.relpath(CACHE, ROOT), len(cache) / 1e6))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
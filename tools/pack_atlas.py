@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""Packs img/*.png into one texture, img/atlas.png, and writes the rect of every
+sprite in it to AtlasRects.h for main.cpp.
+
+Standard library only. Run it from anywhere after changing a sprite:
+
+    python3 tools/pack_atlas.py [--check]
+
+With --check it writes nothing and fails if the outputs are out of date.
+The packing is deterministic, so the same sprites give the same files.
+"""
+import glob
+import os
+import struct
+import sys
+import zlib
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+IMG_DIR = os.path.join(ROOT, 'img')
+ATLAS_PNG = os.path.join(IMG_DIR, 'atlas.png')
+RECTS_H = os.path.join(ROOT, 'AtlasRects.h')
+# transparent pixels around every sprite, so filtering at small scales does not
+# pick up its neighbors
+PADDING = 2
+MAX_SIZE = 8192
+
+
+def read_png(path):
+    """(width, height, RGBA bytes) of an 8-bit, non-interlaced PNG."""
+    data = open(path, 'rb').read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError('%s: not a PNG' % path)
+    pos, idat, palette, trns = 8, [], None, None
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b'IHDR':
+            width, height, depth, color, _, _, interlace = struct.unpack('>IIBBBBB', body)
+        elif kind == b'PLTE':
+            palette = body
+        elif kind == b'tRNS':
+            trns = body
+        elif kind == b'IDAT':
+            idat.append(body)
+        elif kind == b'IEND':
+            break
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(color)
+    if depth != 8 or interlace != 0 or channels is None:
+        raise ValueError('%s: only 8-bit, non-interlaced PNGs are supported' % path)
+
+    raw = zlib.decompress(b''.join(idat))
+    stride = width * channels
+    rows, prev = [], bytearray(stride)
+    for y in range(height):
+        kind = raw[y * (stride + 1)]
+        row = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            a = row[i - channels] if i >= channels else 0
+            b = prev[i]
+            c = prev[i - channels] if i >= channels else 0
+            if kind == 1:
+                row[i] = (row[i] + a) & 0xFF
+            elif kind == 2:
+                row[i] = (row[i] + b) & 0xFF
+            elif kind == 3:
+                row[i] = (row[i] + ((a + b) >> 1)) & 0xFF
+            elif kind == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                row[i] = (row[i] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xFF
+        rows.append(row)
+        prev = row
+
+    rgba = bytearray()
+    for row in rows:
+        if color == 6:
+            rgba += row
+            continue
+        for x in range(width):
+            if color == 2:
+                rgba += row[x * 3:x * 3 + 3] + b'\xff'
+            elif color == 0:
+                rgba += bytes((row[x], row[x], row[x], 255))
+            elif color == 4:
+                rgba += bytes((row[x * 2], row[x * 2], row[x * 2], row[x * 2 + 1]))
+            else:
+                i = row[x]
+                alpha = trns[i] if trns is not None and i < len(trns) else 255
+                rgba += palette[i * 3:i * 3 + 3] + bytes((alpha,))
+    return width, height, bytes(rgba)
+
+
+def write_png(width, height, rgba):
+    def chunk(kind, body):
+        return struct.pack('>I', len(body)) + kind + body + struct.pack('>I', zlib.crc32(kind + body) & 0xFFFFFFFF)
+    stride = width * 4
+    raw = b''.join(b'\x00' + rgba[y * stride:(y + 1) * stride] for y in range(height))
+    return (b'\x89PNG\r\n\x1a\n' + chunk(b'IHDR', struct.pack('>IIBBBBB', width, height, 8, 6, 0, 0, 0))
+            + chunk(b'IDAT', zlib.compress(raw, 9)) + chunk(b'IEND', b''))
+
+
+def pack(sizes, width):
+    """Skyline bottom-left packing of (w, h) boxes into a strip width wide.
+    Returns their positions and the height used, or None if one does not fit."""
+    skyline = [(0, width, 0)]  # (x, width, top) segments, left to right
+    positions = []
+    for w, h in sizes:
+        best = None
+        for i in range(len(skyline)):
+            x = skyline[i][0]
+            if x + w > width:
+                break
+            # the box rests on the highest segment it spans
+            top, j, right = 0, i, x + w
+            while right > skyline[j][0]:
+                top = max(top, skyline[j][2])
+                j += 1
+                if j == len(skyline):
+                    break
+            if best is None or (top + h, x) < (best[0] + h, best[1]):
+                best = (top, x, i)
+        if best is None:
+            return None
+        top, x, i = best
+        positions.append((x, top))
+        # replace the segments under the box by one at its top
+        segments = [(x, w, top + h)]
+        for sx, sw, st in skyline:
+            if sx + sw <= x or sx >= x + w:
+                segments.append((sx, sw, st))
+            else:
+                if sx < x:
+                    segments.append((sx, x - sx, st))
+                if sx + sw > x + w:
+                    segments.append((x + w, sx + sw - x - w, st))
+        skyline = sorted(segments)
+    return positions, max(t for _, _, t in skyline)
+
+
+def build():
+    sprites = []
+    for path in sorted(glob.glob(os.path.join(IMG_DIR, '*.png'))):
+        name = os.path.splitext(os.path.basename(path))[0]
+        if name == 'atlas':
+            continue
+        sprites.append((name,) + read_png(path))
+    order = sorted(range(len(sprites)), key=lambda i: (-sprites[i][2], -sprites[i][1], sprites[i][0]))
+    sizes = [(sprites[i][1] + PADDING * 2, sprites[i][2] + PADDING * 2) for i in order]
+
+    # the smallest power of two wide, then the smallest power of two high, that holds them
+    width = 1
+    while width < max(w for w, _ in sizes):
+        width *= 2
+    while True:
+        positions, used = pack(sizes, width)
+        height = 1
+        while height < used:
+            height *= 2
+        if height <= width or width >= MAX_SIZE:
+            break
+        width *= 2
+    if width > MAX_SIZE or height > MAX_SIZE:
+        raise ValueError('the sprites do not fit in %dx%d' % (MAX_SIZE, MAX_SIZE))
+
+    pixels = bytearray(width * height * 4)
+    rects = {}
+    for i, (px, py) in zip(order, positions):
+        name, w, h, rgba = sprites[i]
+        x, y = px + PADDING, py + PADDING
+        for row in range(h):
+            start = ((y + row) * width + x) * 4
+            pixels[start:start + w * 4] = rgba[row * w * 4:(row + 1) * w * 4]
+        rects[name] = (x, y, w, h)
+
+    names = [s[0] for s in sprites]
+    lines = [
+        '#pragma once',
+        '// Generated by tools/pack_atlas.py from img/*.png; do not edit.',
+        '',
+        '/// the sprites packed into img/atlas.png',
+        'namespace Atlas {',
+        '\tstruct Sprite {',
+        '\t\tchar const* name;',
+        '\t\tint x, y, width, height;',
+        '\t};',
+        '',
+        '\tstatic const int width = %d, height = %d;' % (width, height),
+        '',
+        '\tenum SpriteId {',
+        '\t\t' + ', '.join(names) + ',',
+        '\t\tspriteNum',
+        '\t};',
+        '',
+        '\tstatic const Sprite sprites[spriteNum] = {',
+    ]
+    for name in names:
+        lines.append('\t\t{"%s", %d, %d, %d, %d},' % ((name,) + rects[name]))
+    lines += ['\t};', '}', '']
+    return write_png(width, height, bytes(pixels)), '\n'.join(lines).encode()
+
+
+def main():
+    png, header = build()
+    outputs = [(ATLAS_PNG, png), (RECTS_H, header)]
+    if '--check' in sys.argv[1:]:
+        stale = [path for path, data in outputs if not os.path.exists(path) or open(path, 'rb').read() != data]
+        for path in stale:
+            print('%s is out of date; run tools/pack_atlas.py' % os.path.relpath(path, ROOT))
+        return 1 if stale else 0
+    for path, data in outputs:
+        with open(path, 'wb') as f:
+            f.write(data)
+    print('packed %d sprites into %s' % (header.count(b'\t\t{"'), os.path.relpath(ATLAS_PNG, ROOT)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())